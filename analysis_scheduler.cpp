@@ -0,0 +1,180 @@
+#include "analysis_scheduler.h"
+
+#include <algorithm>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool pinCurrentThread(int core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+const std::complex<float> *FftGatherer::add(const AnalysisFrame &f, size_t fft_size, const AnalysisFrame *&meta, bool &settled) {
+    if (fft_size <= f.block->size) {
+        fill = 0;
+        meta = &f;
+        settled = f.settled;
+        return f.block->data;
+    }
+    if (window.size() != fft_size) {
+        window.resize(fft_size);
+        fill = 0;
+    }
+    if (fill > 0 && f.first_index != next) fill = 0;
+    if (fill == 0) {
+        first = f;
+        first.block.reset(); // Only the timing is kept
+        all_settled = true;
+    }
+    size_t n = std::min(f.block->size, fft_size - fill);
+    std::copy(f.block->data, f.block->data + n, window.begin() + fill);
+    fill += n;
+    next = f.first_index + f.block->size;
+    all_settled = all_settled && f.settled && f.center_hz == first.center_hz;
+    if (fill < fft_size) return nullptr;
+    fill = 0;
+    meta = &first;
+    settled = all_settled;
+    return window.data();
+}
+
+AnalysisScheduler::~AnalysisScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto &t : threads) t.join();
+}
+
+int AnalysisScheduler::addTask(const std::string &name, int priority, double deadline_ms, TaskFn fn, size_t max_queue) {
+    auto t = std::make_unique<Task>();
+    t->name = name;
+    t->priority = priority;
+    t->deadline_ns = int64_t(deadline_ms * 1e6);
+    t->max_queue = max_queue;
+    t->fn = std::move(fn);
+    tasks.push_back(std::move(t));
+    return int(tasks.size() - 1);
+}
+
+void AnalysisScheduler::start(size_t reserved_cores) {
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t n = cores > reserved_cores ? cores - reserved_cores : 1;
+    bool pin = cores > reserved_cores;
+    queues.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        queues[i] = std::make_unique<WorkQueue>();
+    }
+    for (size_t i = 0; i < n; i++) {
+        threads.emplace_back([this, i, pin] {
+            if (pin) pinCurrentThread(int(i));
+            setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 5);
+            workerLoop(i);
+        });
+    }
+}
+
+void AnalysisScheduler::post(int task, FrameRef frame) {
+    Task &t = *tasks[task];
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if (t.deadline_ns > 0 && t.mailbox.size() >= t.max_queue) {
+            t.mailbox.pop_front();
+            t.dropped++;
+        }
+        t.mailbox.push_back(std::move(frame));
+        if (!t.scheduled) t.scheduled = schedule = true;
+    }
+    if (schedule) enqueue(next_queue++ % queues.size(), &t);
+}
+
+std::vector<AnalysisScheduler::TaskStats> AnalysisScheduler::stats() const {
+    std::vector<TaskStats> out;
+    for (const auto &t : tasks) {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        out.push_back({t->name, t->priority, t->deadline_ns / 1e6, t->processed, t->dropped,
+                       t->mailbox.size(), t->latency_avg_ms, t->latency_max_ms});
+    }
+    return out;
+}
+
+void AnalysisScheduler::enqueue(size_t q, Task *t) {
+    {
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        queues[q]->tasks.push_back(t);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+AnalysisScheduler::Task *AnalysisScheduler::take(size_t q) {
+    WorkQueue &wq = *queues[q];
+    std::lock_guard<std::mutex> lock(wq.mutex);
+    if (wq.tasks.empty()) return nullptr;
+    auto best = std::max_element(wq.tasks.begin(), wq.tasks.end(),
+                                 [](Task *a, Task *b) { return a->priority < b->priority; });
+    Task *t = *best;
+    wq.tasks.erase(best);
+    return t;
+}
+
+void AnalysisScheduler::workerLoop(size_t self) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait(lock, [this] { return quit || queued > 0; });
+            if (quit) return;
+        }
+
+        // Own queue first, then steal from the others
+        Task *t = take(self);
+        for (size_t k = 1; !t && k < queues.size(); k++) t = take((self + k) % queues.size());
+        if (!t) continue;
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            queued--;
+        }
+
+        FrameRef frame;
+        {
+            std::lock_guard<std::mutex> lock(t->mutex);
+            int64_t now = nowNs();
+            while (t->deadline_ns > 0 && !t->mailbox.empty() &&
+                   now - t->mailbox.front()->posted_ns > t->deadline_ns) {
+                t->mailbox.pop_front();
+                t->dropped++;
+            }
+            if (t->mailbox.empty()) {
+                t->scheduled = false;
+                continue;
+            }
+            frame = std::move(t->mailbox.front());
+            t->mailbox.pop_front();
+        }
+
+        t->fn(*frame);
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(t->mutex);
+            double ms = (nowNs() - frame->posted_ns) / 1e6;
+            t->processed++;
+            t->latency_avg_ms = (t->processed == 1) ? ms : 0.95 * t->latency_avg_ms + 0.05 * ms;
+            t->latency_max_ms = std::max(t->latency_max_ms, ms);
+            more = !t->mailbox.empty();
+            if (!more) t->scheduled = false;
+        }
+        if (more) enqueue(self, t);
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "block_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pins the calling thread to one core; returns false if the OS refused
+bool pinCurrentThread(int core);
+
+// One received frame as seen by the analysis tasks
+struct AnalysisFrame {
+    BlockRef block;        // RX samples, shared by every task that reads them
+    uint64_t first_index;  // Stream index of block->data[0]
+    double time_s;         // Stream time of block->data[0]
+    double center_hz;      // RX tuning at capture
+    bool settled;          // False while the LO settles after a retune or gain step
+    int64_t posted_ns;     // Host steady-clock time the frame was posted
+    double rx_gain_db;     // Device RX gain at block->data[0]
+    size_t gain_step_at;   // Offset of a gain change inside the block, or its size if none
+    double gain_step_db;   // Gain from gain_step_at on
+};
+using FrameRef = std::shared_ptr<const AnalysisFrame>;
+
+// One spectrum-task output, shared by the view and the freeze history
+struct SpectrumFrame {
+    uint64_t first_index; // First sample the FFT covered
+    double time_s;
+    double center_hz;
+    std::vector<float> psd_db;
+};
+using SpectrumRef = std::shared_ptr<const SpectrumFrame>;
+
+// Gathers consecutive frames for an FFT longer than one frame; a gap in the
+// stream starts over. Shorter FFTs take the frame as it is.
+class FftGatherer {
+public:
+    // The FFT input once fft_size samples are in, else null. 'meta' is then
+    // the frame they start in and 'settled' whether every frame was.
+    const std::complex<float> *add(const AnalysisFrame &f, size_t fft_size, const AnalysisFrame *&meta, bool &settled);
+
+private:
+    std::vector<std::complex<float>> window;
+    size_t fill = 0;
+    uint64_t next = 0;
+    AnalysisFrame first{};
+    bool all_settled = true;
+};
+
+// Runs analysis tasks off the radio thread on a work-stealing pool. Each task
+// sees its frames in order, one at a time; different tasks run in parallel.
+// A task with a deadline drops frames that went stale while queued, so under
+// overload it processes recent data instead of growing a backlog. Tasks
+// without a deadline (demodulators, correlators) never drop a frame they were
+// posted; their backlog is bounded by the frame pool, and once a slow task
+// holds every block the radio stops handing out frames until it catches up.
+// So under sustained overload frames go unanalyzed rather than queued, and
+// the worker counts them. Pool threads run at lower priority and stay off
+// the radio core.
+class AnalysisScheduler {
+public:
+    using TaskFn = std::function<void(const AnalysisFrame &)>;
+
+    struct TaskStats {
+        std::string name;
+        int priority;
+        double deadline_ms;
+        uint64_t processed, dropped;
+        size_t backlog; // Frames waiting in the mailbox
+        double avg_latency_ms, max_latency_ms;
+    };
+
+    ~AnalysisScheduler();
+
+    // Higher priority runs first. A task with deadline_ms > 0 keeps at most
+    // max_queue frames and drops the oldest; deadline_ms <= 0 keeps them all,
+    // bounded by the pool the frames come from. Tasks must be added before
+    // start().
+    int addTask(const std::string &name, int priority, double deadline_ms, TaskFn fn, size_t max_queue = 64);
+
+    // Starts one thread per core except the last 'reserved_cores', which
+    // belong to the radio
+    void start(size_t reserved_cores);
+
+    size_t threadCount() const { return threads.size(); }
+
+    void post(int task, FrameRef frame);
+
+    std::vector<TaskStats> stats() const;
+
+private:
+    struct Task {
+        std::string name;
+        int priority = 0;
+        int64_t deadline_ns = 0;
+        size_t max_queue = 64;
+        TaskFn fn;
+        mutable std::mutex mutex;
+        std::deque<FrameRef> mailbox;
+        bool scheduled = false; // In a work queue or running
+        uint64_t processed = 0, dropped = 0;
+        double latency_avg_ms = 0, latency_max_ms = 0;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task *> tasks;
+    };
+
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next_queue{0};
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    size_t queued = 0; // Tasks sitting in work queues, guarded by wake_mutex
+    bool quit = false;
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void enqueue(size_t q, Task *t);
+
+    // Highest-priority task in queue q, or nullptr
+    Task *take(size_t q);
+
+    void workerLoop(size_t self);
+};
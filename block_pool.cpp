@@ -0,0 +1,45 @@
+#include "block_pool.h"
+
+void BlockPoolState::release(SampleBlock *blk) {
+    BlockPoolState *state = blk->pool;
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->free_list.push_back(blk);
+        last = --state->out == 0 && state->closed;
+    }
+    if (last) delete state;
+}
+
+BlockPool::BlockPool(size_t block_samples, size_t count): state(new BlockPoolState) {
+    state->slab.resize(block_samples * count);
+    state->blocks.reset(new SampleBlock[count]);
+    for (size_t i = 0; i < count; i++) {
+        SampleBlock &b = state->blocks[i];
+        b.data = state->slab.data() + i * block_samples;
+        b.size = 0;
+        b.capacity = block_samples;
+        b.pool = state;
+        state->free_list.push_back(&b);
+    }
+}
+
+BlockPool::~BlockPool() {
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->closed = true;
+        idle = state->out == 0;
+    }
+    if (idle) delete state;
+}
+
+BlockRef BlockPool::acquire() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->free_list.empty()) return nullptr;
+    SampleBlock *b = state->free_list.back();
+    state->free_list.pop_back();
+    state->out++;
+    b->size = 0;
+    return BlockRef(b);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "sample_buffers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A block of samples on loan from a BlockPool, interleaved as received.
+// Planar consumers split it themselves. The reference count lives in the
+// block, so lending one out allocates nothing.
+struct BlockPoolState;
+struct SampleBlock {
+    std::complex<float> *data;
+    size_t size;      // Valid samples
+    size_t capacity;
+    std::atomic<int> refs{0};
+    BlockPoolState *pool;
+};
+
+// Shared handle to a pooled block; the last one returns it to the pool
+class BlockRef {
+public:
+    BlockRef() = default;
+    BlockRef(std::nullptr_t) {}
+    BlockRef(const BlockRef &o) : b(o.b) {
+        if (b) b->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    BlockRef(BlockRef &&o) noexcept : b(o.b) { o.b = nullptr; }
+    BlockRef &operator=(BlockRef o) noexcept {
+        std::swap(b, o.b);
+        return *this;
+    }
+    ~BlockRef() { reset(); }
+
+    inline void reset();
+    SampleBlock *get() const { return b; }
+    SampleBlock *operator->() const { return b; }
+    SampleBlock &operator*() const { return *b; }
+    explicit operator bool() const { return b != nullptr; }
+
+private:
+    friend class BlockPool;
+    explicit BlockRef(SampleBlock *blk) : b(blk) { b->refs.store(1, std::memory_order_relaxed); }
+    SampleBlock *b = nullptr;
+};
+
+// The pool's storage. It outlives the BlockPool while blocks are still out
+// (a frozen view may hold some after the worker stopped); the last block
+// back frees it.
+struct BlockPoolState {
+    ArenaSampleVector slab;
+    std::unique_ptr<SampleBlock[]> blocks;
+    std::vector<SampleBlock *> free_list;
+    size_t out = 0;      // Blocks on loan
+    bool closed = false; // The BlockPool is gone
+    std::mutex mutex;
+
+    static void release(SampleBlock *blk);
+};
+
+inline void BlockRef::reset() {
+    if (b && b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) BlockPoolState::release(b);
+    b = nullptr;
+}
+
+// Fixed-size sample blocks carved out of one allocation and recycled through
+// a free list. Blocks are lent out as intrusively counted BlockRefs that
+// return themselves to the pool, so they can be passed between threads
+// without copies or malloc.
+class BlockPool {
+public:
+    BlockPool(size_t block_samples, size_t count);
+
+    BlockPool(const BlockPool &) = delete;
+    BlockPool &operator=(const BlockPool &) = delete;
+
+    ~BlockPool();
+
+    // Returns nullptr when every block is out
+    BlockRef acquire();
+
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->free_list.size();
+    }
+
+private:
+    BlockPoolState *state;
+};
@@ -0,0 +1,276 @@
+#include "capture_ring.h"
+#include "file_io.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+CaptureRing::~CaptureRing() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    writer.join();
+    HugePages::unmap(ring, cap * sizeof(std::complex<float>));
+}
+
+void CaptureRing::push(const std::complex<float> *in, size_t n, double center_hz) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if (center_hz != last_center) {
+        tunes.add(h, center_hz);
+        last_center = center_hz;
+    }
+    size_t pos = h % cap, first = std::min(n, cap - pos);
+    std::copy(in, in + first, ring + pos);
+    std::copy(in + first, in + n, ring);
+    wall_at_head.store(wallSeconds(), std::memory_order_relaxed);
+    head.store(h + n, std::memory_order_release);
+}
+
+void CaptureRing::trigger(uint64_t index, const std::string &reason, double lo_hz, double hi_hz) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (incoming.size() >= max_incoming) return;
+        incoming.push_back({index, 1, reason, lo_hz, hi_hz});
+    }
+    triggers++;
+    wake.notify_one();
+}
+
+CaptureRing::Status CaptureRing::status() const {
+    Status s;
+    s.triggers = triggers;
+    s.recordings = recordings;
+    s.overruns = overruns;
+    s.writing = writing;
+    std::lock_guard<std::mutex> lock(mutex);
+    s.last_file = last_file;
+    return s;
+}
+
+bool CaptureRing::locate(const std::string &dir, double wall_s, std::string &file, uint64_t &sample) {
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::filesystem::path &path = entry.path();
+        if (path.extension() != ".sigmf-meta" || path.filename().string().rfind("capture_", 0) != 0) continue;
+        std::ifstream meta(path);
+        std::stringstream text;
+        text << meta.rdbuf();
+        std::string json = text.str();
+
+        double rate = atof(sigmfField(json, "core:sample_rate").c_str());
+        tm utc = {};
+        double secs = 0;
+        if (sscanf(sigmfField(json, "core:datetime").c_str(), "%d-%d-%dT%d:%d:%lf", &utc.tm_year, &utc.tm_mon,
+                   &utc.tm_mday, &utc.tm_hour, &utc.tm_min, &secs) != 6 || rate <= 0) continue;
+        utc.tm_year -= 1900;
+        utc.tm_mon -= 1;
+        double start = timegm(&utc) + secs;
+
+        std::filesystem::path data = path;
+        data.replace_extension(".sigmf-data");
+        uintmax_t samples = std::filesystem::file_size(data, ec) / sizeof(std::complex<float>);
+        if (ec || wall_s < start || wall_s >= start + samples / rate) continue;
+        file = data.string();
+        sample = uint64_t((wall_s - start) * rate);
+        return true;
+    }
+    return false;
+}
+
+void CaptureRing::writerLoop() {
+    std::deque<Recording> queued;
+    Recording active;
+    std::vector<Annotation> batch;
+    bool done = false;
+    while (!done) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(20), [&] { return stopping || !incoming.empty(); });
+            batch.swap(incoming);
+            done = stopping;
+        }
+
+        for (auto &a : batch) {
+            Recording *into = active.fp ? &active : queued.empty() ? nullptr : &queued.back();
+            // Overlapping windows make one recording rather than two copies
+            if (into && a.index >= into->start && a.index <= into->stop + pre) {
+                into->stop = std::max(into->stop, std::min(a.index + post, into->start + cap));
+                annotate(*into, a);
+                continue;
+            }
+            Recording r;
+            r.start = a.index > pre ? a.index - pre : 0;
+            r.stop = a.index + post;
+            annotate(r, a);
+            queued.push_back(std::move(r));
+        }
+        batch.clear();
+
+        if (!active.fp && !queued.empty()) {
+            active = std::move(queued.front());
+            queued.pop_front();
+            begin(active);
+        }
+        if (active.fp) {
+            writeAvailable(active);
+            // On shutdown the post-trigger part that never arrived is
+            // missing, which the metadata says
+            if (active.written >= active.stop || done) finish(active);
+        }
+    }
+    for (auto &r : queued) {
+        begin(r);
+        if (!r.fp) continue;
+        writeAvailable(r);
+        finish(r);
+    }
+}
+
+void CaptureRing::annotate(Recording &r, const Annotation &a) {
+    for (auto it = r.annotations.rbegin(); it != r.annotations.rend(); ++it) {
+        if (it->reason != a.reason) continue;
+        // Repeats of one event (a signal seen in consecutive frames) merge
+        if (a.index >= it->index && a.index <= it->index + it->count + guard) {
+            it->count = a.index - it->index + 1;
+            it->lo_hz = std::min(it->lo_hz, a.lo_hz);
+            it->hi_hz = std::max(it->hi_hz, a.hi_hz);
+            return;
+        }
+        break;
+    }
+    if (r.annotations.size() < max_annotations) r.annotations.push_back(a);
+}
+
+void CaptureRing::begin(Recording &r) {
+    uint64_t oldest = oldestSafe();
+    if (r.start < oldest) {
+        // Before the ring first fills this just means less pre-trigger
+        if (oldest > 0) r.lost = true;
+        r.start = oldest;
+    }
+    r.written = r.start;
+    r.start_wall = wall_at_head.load() - (end() - r.start) / sample_rate;
+
+    // Center and gain at the first sample, then every change after it
+    r.captures.push_back({r.start, tunes.at(r.start, r.tune_cursor)});
+    double gain = gains.at(r.start, r.gain_cursor);
+    if (!std::isnan(gain)) r.gains.push_back({r.start, gain});
+
+    char stamp[32];
+    time_t secs = time_t(r.start_wall);
+    tm utc;
+    gmtime_r(&secs, &utc);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+    r.base = directory + "/capture_" + stamp + "_" + std::to_string(recordings.load());
+    r.fp = fopen((r.base + ".sigmf-data").c_str(), "wb");
+    if (!r.fp) {
+        std::lock_guard<std::mutex> lock(mutex);
+        last_file = "cannot create " + r.base + ".sigmf-data";
+        r = Recording();
+        return;
+    }
+    setvbuf(r.fp, nullptr, _IOFBF, 1 << 20);
+    writing = true;
+}
+
+void CaptureRing::writeAvailable(Recording &r) {
+    uint64_t limit = std::min(r.stop, end());
+    if (r.written >= limit) return;
+    if (r.written < oldestSafe()) {
+        r.lost = true;
+        r.stop = r.written; // Everything after would have a hole in it
+        return;
+    }
+
+    tunes.take(r.tune_cursor, limit, r.captures);
+    gains.take(r.gain_cursor, limit, r.gains);
+
+    uint64_t from = r.written;
+    while (from < limit) {
+        size_t pos = from % cap, n = std::min<uint64_t>(limit - from, cap - pos);
+        fwrite(ring + pos, sizeof(std::complex<float>), n, r.fp);
+        from += n;
+    }
+    // The ring may have lapped what was just written while it was written
+    if (r.written < oldestSafe()) {
+        r.lost = true;
+        r.stop = r.written;
+        return;
+    }
+    r.written = limit;
+}
+
+void CaptureRing::finish(Recording &r) {
+    fclose(r.fp);
+    if (r.lost) overruns++;
+    writeMeta(r);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        last_file = r.base + ".sigmf-data";
+    }
+    recordings++;
+    writing = false;
+    r = Recording();
+}
+
+void CaptureRing::writeMeta(const Recording &r) {
+    std::ofstream meta(r.base + ".sigmf-meta");
+    meta.precision(15);
+    meta << "{\n  \"global\": {\n"
+         << "    \"core:datatype\": \"cf32_le\",\n"
+         << "    \"core:sample_rate\": " << sample_rate << ",\n"
+         << "    \"core:version\": \"1.0.0\",\n"
+         << "    \"core:recorder\": \"usrp_viz\",\n"
+         << "    \"core:description\": \"Pre-trigger capture"
+         << (r.lost ? ", incomplete: the ring overran the writer" : "")
+         << (r.written < r.stop ? ", cut short: recording stopped before the window ended" : "") << "\"\n  },\n";
+
+    char stamp[40];
+    time_t secs = time_t(r.start_wall);
+    tm utc;
+    gmtime_r(&secs, &utc);
+    size_t len = strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(stamp + len, sizeof(stamp) - len, ".%06dZ", int((r.start_wall - secs) * 1e6));
+
+    meta << "  \"captures\": [";
+    for (size_t i = 0; i < r.captures.size(); i++) {
+        meta << (i ? ",\n" : "\n") << "    {\"core:sample_start\": " << r.captures[i].first - r.start
+             << ", \"core:frequency\": " << r.captures[i].second;
+        if (i == 0) meta << ", \"core:datetime\": \"" << stamp << "\"";
+        meta << "}";
+    }
+    meta << "\n  ],\n  \"annotations\": [";
+
+    // Events and gain changes, in sample order as SigMF wants. A gain
+    // annotation covers the samples recorded at that gain.
+    std::vector<std::pair<uint64_t, std::string>> lines;
+    for (const auto &a : r.annotations) {
+        if (a.index < r.start || a.index >= r.written) continue;
+        std::ostringstream line;
+        line.precision(15);
+        line << "    {\"core:sample_start\": " << a.index - r.start
+             << ", \"core:sample_count\": " << std::min(a.count, r.written - a.index)
+             << ", \"core:label\": \"" << a.reason << "\"";
+        if (a.hi_hz > a.lo_hz) line << ", \"core:freq_lower_edge\": " << a.lo_hz << ", \"core:freq_upper_edge\": " << a.hi_hz;
+        line << "}";
+        lines.push_back({a.index, line.str()});
+    }
+    for (size_t i = 0; i < r.gains.size(); i++) {
+        uint64_t from = r.gains[i].first, to = i + 1 < r.gains.size() ? r.gains[i + 1].first : r.written;
+        if (from >= r.written) break;
+        std::ostringstream line;
+        line << "    {\"core:sample_start\": " << from - r.start << ", \"core:sample_count\": " << to - from
+             << ", \"core:label\": \"rx gain " << r.gains[i].second << " dB\"}";
+        lines.push_back({from, line.str()});
+    }
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (size_t i = 0; i < lines.size(); i++) meta << (i ? ",\n" : "\n") << lines[i].second;
+    meta << "\n  ]\n}\n";
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "sample_buffers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Last few frames of a stream by absolute sample index, so a trigger can
+// pull out a window that started before the frame it was detected in.
+class RecentSamples {
+public:
+    explicit RecentSamples(size_t capacity = 1 << 15) : ring(capacity) {}
+
+    void push(const std::complex<float> *in, size_t n) {
+        for (size_t i = 0; i < n; i++) ring[(total + i) % ring.size()] = in[i];
+        total += n;
+    }
+
+    uint64_t end() const { return total; }
+    size_t capacity() const { return ring.size(); }
+
+    bool copy(uint64_t start, size_t n, std::vector<std::complex<float>> &out) const {
+        if (start + n > total || total - start > ring.size()) return false;
+        out.resize(n);
+        for (size_t i = 0; i < n; i++) out[i] = ring[(start + i) % ring.size()];
+        return true;
+    }
+
+private:
+    ArenaSampleVector ring;
+    uint64_t total = 0;
+};
+
+// Pre-trigger recorder. The last few seconds of RX sit in one big ring that
+// the radio thread copies each frame into (the frame itself stays in the
+// pooled block the analysis tasks share); a trigger asks the background
+// writer to save [index - pre, index + post) as a SigMF recording. The writer
+// fwrite()s straight out of the ring, so saving copies nothing more, and the
+// radio never waits for it: if the disk falls so far behind that the ring
+// laps samples not yet saved, the recording is cut short and counted as an
+// overrun. Triggers that land inside a recording extend it, up to the length
+// of the ring. Recordings still pending at shutdown are saved from what the
+// ring holds.
+class CaptureRing {
+public:
+    struct Status {
+        uint64_t triggers = 0;
+        uint64_t recordings = 0; // Finished recordings
+        uint64_t overruns = 0;   // Recordings that lost samples to the ring
+        bool writing = false;
+        std::string last_file;
+    };
+
+    CaptureRing(size_t capacity, size_t frame, double rate, const std::string &dir)
+        : cap(capacity), guard(frame), sample_rate(rate), directory(dir),
+          tunes(capacity / frame + 2), gains(capacity / frame + 2) {
+        ring = static_cast<std::complex<float> *>(HugePages::map(cap * sizeof(std::complex<float>)));
+        std::fill(ring, ring + cap, std::complex<float>()); // Fault it in now, not from the radio path
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    ~CaptureRing();
+
+    // Radio thread only; the samples continue the stream where the last push ended
+    void push(const std::complex<float> *in, size_t n, double center_hz);
+
+    // Radio thread only. The RX gain from stream index 'index' on, which may
+    // lie inside the last push; at most one change per pushed frame.
+    void tagGain(uint64_t index, double gain_db) { gains.add(index, gain_db); }
+
+    // Stream index one past the newest sample
+    uint64_t end() const { return head.load(std::memory_order_acquire); }
+
+    // Any thread. The band edges are optional and end up in the annotation.
+    void trigger(uint64_t index, const std::string &reason, double lo_hz = 0, double hi_hz = 0);
+
+    void setWindow(double pre_s, double post_s) {
+        pre = size_t(std::min<double>(std::max(0.0, pre_s) * sample_rate, cap - 2 * guard));
+        post = size_t(std::max(0.0, post_s) * sample_rate);
+    }
+
+    Status status() const;
+
+    size_t bytes() const { return HugePages::roundUp(cap * sizeof(std::complex<float>)); }
+    double seconds() const { return cap / sample_rate; }
+
+    // Finds the recording in 'dir' that holds Unix time 'wall_s'
+    static bool locate(const std::string &dir, double wall_s, std::string &file, uint64_t &sample);
+
+private:
+    // Values that change at a stream index (RX tuning, RX gain), added by the
+    // radio thread and read by the writer. There is one slot per ring frame,
+    // so every change still in the ring is still here.
+    class MarkLog {
+    public:
+        explicit MarkLog(size_t slots) : slot_count(slots), marks(new Mark[slots]) {}
+
+        void add(uint64_t index, double value) {
+            uint64_t t = count.load(std::memory_order_relaxed);
+            marks[t % slot_count].index.store(index, std::memory_order_relaxed);
+            marks[t % slot_count].value.store(value, std::memory_order_relaxed);
+            count.store(t + 1, std::memory_order_release);
+        }
+
+        // The value at 'index' (NAN if none was ever set); 'cursor' is left at
+        // the first change after it
+        double at(uint64_t index, uint64_t &cursor) const {
+            uint64_t n = count.load(std::memory_order_acquire);
+            cursor = n > slot_count ? n - slot_count : 0;
+            double value = cursor < n ? marks[cursor % slot_count].value.load() : NAN;
+            while (cursor < n && marks[cursor % slot_count].index <= index) value = marks[cursor++ % slot_count].value;
+            return value;
+        }
+
+        // Changes from 'cursor' on that start before 'limit', oldest first
+        void take(uint64_t &cursor, uint64_t limit, std::vector<std::pair<uint64_t, double>> &out) const {
+            uint64_t n = count.load(std::memory_order_acquire);
+            while (cursor < n && marks[cursor % slot_count].index < limit) {
+                const Mark &m = marks[cursor++ % slot_count];
+                out.push_back({m.index, m.value});
+            }
+        }
+
+    private:
+        struct Mark {
+            std::atomic<uint64_t> index{0};
+            std::atomic<double> value{0};
+        };
+        size_t slot_count;
+        std::unique_ptr<Mark[]> marks;
+        std::atomic<uint64_t> count{0};
+    };
+
+    struct Annotation {
+        uint64_t index, count;
+        std::string reason;
+        double lo_hz, hi_hz;
+    };
+    struct Recording {
+        uint64_t start = 0, stop = 0, written = 0;
+        std::vector<Annotation> annotations;
+        std::vector<std::pair<uint64_t, double>> captures; // Stream index, center
+        std::vector<std::pair<uint64_t, double>> gains;    // Stream index, RX gain
+        uint64_t tune_cursor = 0, gain_cursor = 0;
+        double start_wall = 0;
+        bool lost = false;
+        FILE *fp = nullptr;
+        std::string base;
+    };
+
+    static constexpr size_t max_incoming = 4096;
+    static constexpr size_t max_annotations = 1000;
+
+    size_t cap, guard; // A push may overwrite up to 'guard' samples past the head
+    double sample_rate;
+    std::string directory;
+    std::complex<float> *ring;
+    std::atomic<uint64_t> head{0};
+    std::atomic<double> wall_at_head{0};
+    double last_center = NAN; // Radio thread only
+
+    // Retunes become the SigMF captures of each recording, gain changes its
+    // "rx gain" annotations
+    MarkLog tunes, gains;
+
+    std::atomic<size_t> pre{0}, post{0};
+    std::atomic<uint64_t> triggers{0}, recordings{0}, overruns{0};
+    std::atomic<bool> writing{false};
+
+    mutable std::mutex mutex; // Never held across I/O
+    std::condition_variable wake;
+    std::vector<Annotation> incoming;
+    std::string last_file;
+    bool stopping = false;
+    std::thread writer;
+
+    static double wallSeconds() {
+        return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Oldest sample the ring still holds and no push can be overwriting
+    uint64_t oldestSafe() const {
+        uint64_t h = end();
+        return h + guard > cap ? h + guard - cap : 0;
+    }
+
+    void writerLoop();
+
+    void annotate(Recording &r, const Annotation &a);
+
+    void begin(Recording &r);
+
+    void writeAvailable(Recording &r);
+
+    void finish(Recording &r);
+
+    void writeMeta(const Recording &r);
+};
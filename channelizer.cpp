@@ -0,0 +1,125 @@
+#include "channelizer.h"
+
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+void PolyphaseChannelizer::configure(size_t channels, size_t oversample, size_t taps_per_branch) {
+    M = channels;
+    os = oversample;
+    hop = M / os;
+    L = M * taps_per_branch;
+
+    // Windowed-sinc prototype, cutoff at half the channel spacing, unity DC gain
+    proto.resize(L);
+    double sum = 0;
+    for (size_t i = 0; i < L; i++) {
+        double t = (double)i - (L - 1) / 2.0;
+        double x = t / M;
+        double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double w = 0.42 - 0.5 * cos(2 * M_PI * i / (L - 1)) + 0.08 * cos(4 * M_PI * i / (L - 1)); // Blackman
+        proto[i] = sinc * w;
+        sum += proto[i];
+    }
+    for (auto &h : proto) h /= sum;
+
+    hist.assign(2 * L, 0.0f);
+    write_pos = 0;
+    pending = 0;
+    hops = 0;
+    fft.resize(M);
+    branch.resize(M);
+}
+
+void PolyphaseChannelizer::process(const std::complex<float> *in, size_t n, std::vector<std::vector<std::complex<float>>> &out) {
+    out.resize(M);
+    for (size_t i = 0; i < n; i++) {
+        write_pos = (write_pos + 1) % L;
+        hist[write_pos] = in[i];
+        hist[write_pos + L] = in[i];
+        if (++pending < hop) continue;
+        pending = 0;
+
+        // Newest sample is hist[write_pos + L]; x[n - j] = hist[write_pos + L - j]
+        const std::complex<float> *newest = &hist[write_pos + L];
+        for (size_t m = 0; m < M; m++) {
+            std::complex<float> acc = 0.0f;
+            for (size_t j = m; j < L; j += M) acc += proto[j] * *(newest - j);
+            branch[m] = acc;
+        }
+        fft.inverse(branch.data());
+
+        // With a hop of M/2 every odd channel picks up a (-1)^t rotation
+        bool flip = (os == 2) && (hops & 1);
+        for (size_t k = 0; k < M; k++) {
+            out[k].push_back((flip && (k & 1)) ? -branch[k] : branch[k]);
+        }
+        hops++;
+    }
+}
+
+bool ChannelRecorder::open(const std::string &dir, size_t channel_count, size_t oversample, double input_rate, double center_hz) {
+    close();
+    spacing = input_rate / channel_count;
+    rate = spacing * oversample;
+    start_wall = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    char stamp[32];
+    time_t secs = time_t(start_wall);
+    tm utc;
+    gmtime_r(&secs, &utc);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+    base = dir + "/channels_" + stamp;
+    for (size_t k = 0; k < channel_count; k++) {
+        FILE *fp = fopen(dataName(k).c_str(), "wb");
+        if (!fp) {
+            close();
+            return false;
+        }
+        setvbuf(fp, nullptr, _IOFBF, 1 << 18);
+        files.push_back(fp);
+    }
+    samples = 0;
+    centers.assign(1, {0, center_hz});
+    return true;
+}
+
+void ChannelRecorder::close() {
+    if (files.empty()) return;
+    for (size_t k = 0; k < files.size(); k++) {
+        fclose(files[k]);
+        writeMeta(k);
+    }
+    files.clear();
+}
+
+void ChannelRecorder::writeMeta(size_t k) const {
+    std::string data = dataName(k);
+    std::ofstream meta(data.substr(0, data.size() - 4) + "meta");
+    meta.precision(15);
+    meta << "{\n  \"global\": {\n"
+         << "    \"core:datatype\": \"cf32_le\",\n"
+         << "    \"core:sample_rate\": " << rate << ",\n"
+         << "    \"core:version\": \"1.0.0\",\n"
+         << "    \"core:recorder\": \"usrp_viz\",\n"
+         << "    \"core:description\": \"Channel " << k << " of " << files.size() << "\"\n  },\n";
+
+    char stamp[40];
+    time_t secs = time_t(start_wall);
+    tm utc;
+    gmtime_r(&secs, &utc);
+    size_t len = strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(stamp + len, sizeof(stamp) - len, ".%06dZ", int((start_wall - secs) * 1e6));
+
+    meta << "  \"captures\": [";
+    for (size_t i = 0; i < centers.size(); i++) {
+        meta << (i ? ",\n" : "\n") << "    {\"core:sample_start\": " << centers[i].first
+             << ", \"core:frequency\": " << centers[i].second + offset(k);
+        if (i == 0) meta << ", \"core:datetime\": \"" << stamp << "\"";
+        meta << "}";
+    }
+    meta << "\n  ],\n  \"annotations\": []\n}\n";
+}
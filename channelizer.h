@@ -0,0 +1,84 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// FFT-based polyphase filterbank. Splits the input into M channels centered
+// at k*fs/M (k > M/2 are the negative frequencies) in one pass: each hop
+// runs M short branch filters and one M-point FFT instead of M separate DDCs.
+// oversample = 1 gives critically sampled channels at fs/M, oversample = 2
+// gives channels at 2*fs/M with overlapping passbands.
+class PolyphaseChannelizer {
+public:
+    void configure(size_t channels, size_t oversample = 1, size_t taps_per_branch = 8);
+
+    size_t channels() const { return M; }
+    size_t oversample() const { return os; }
+
+    // Appends the new output samples of every channel to out[k]
+    void process(const std::complex<float> *in, size_t n, std::vector<std::vector<std::complex<float>>> &out);
+
+private:
+    size_t M = 0, os = 1, hop = 0, L = 0;
+    std::vector<float> proto;
+    std::vector<std::complex<float>> hist; // Input history stored twice for contiguous reads
+    size_t write_pos = 0;
+    size_t pending = 0;
+    uint64_t hops = 0;
+    FFT fft;
+    std::vector<std::complex<float>> branch;
+};
+
+// Records every channel of a PolyphaseChannelizer to its own SigMF pair,
+// "<base>_chNNN.sigmf-data/-meta", from one pass of the filterbank. Retunes
+// become new captures in every file. Not thread-safe; one task owns it.
+class ChannelRecorder {
+public:
+    ~ChannelRecorder() { close(); }
+
+    bool isOpen() const { return !files.empty(); }
+    size_t channels() const { return files.size(); }
+    double secondsWritten() const { return rate > 0 ? samples / rate : 0.0; }
+    const std::string &baseName() const { return base; }
+
+    // 'input_rate' and 'oversample' as given to the channelizer
+    bool open(const std::string &dir, size_t channel_count, size_t oversample, double input_rate, double center_hz);
+
+    // One channelizer output; 'center_hz' is the RX tuning it came from
+    void write(const std::vector<std::vector<std::complex<float>>> &out, double center_hz) {
+        if (files.empty() || out.size() != files.size()) return;
+        if (center_hz != centers.back().second) centers.push_back({samples, center_hz});
+        for (size_t k = 0; k < files.size(); k++) fwrite(out[k].data(), sizeof(std::complex<float>), out[k].size(), files[k]);
+        samples += out[0].size();
+    }
+
+    void close();
+
+private:
+    std::vector<FILE *> files;
+    std::vector<std::pair<uint64_t, double>> centers; // Channel sample index, RX center
+    std::string base;
+    double spacing = 0, rate = 0, start_wall = 0;
+    uint64_t samples = 0; // Per channel
+
+    std::string dataName(size_t k) const {
+        char suffix[24];
+        snprintf(suffix, sizeof(suffix), "_ch%03zu.sigmf-data", k);
+        return base + suffix;
+    }
+
+    // Channel k sits at k * spacing; the upper half are the negative ones
+    double offset(size_t k) const {
+        long m = long(files.size());
+        return (long(k) <= m / 2 ? long(k) : long(k) - m) * spacing;
+    }
+
+    void writeMeta(size_t k) const;
+};
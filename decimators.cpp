@@ -0,0 +1,56 @@
+#include "decimators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+std::vector<float> lowpassTaps(size_t num_taps, double cutoff) {
+    std::vector<float> taps(num_taps);
+    double sum = 0;
+    for (size_t i = 0; i < num_taps; i++) {
+        double t = (double)i - (num_taps - 1) / 2.0;
+        double sinc = (t == 0.0) ? 2 * cutoff : sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        double w = 0.42 - 0.5 * cos(2 * M_PI * i / (num_taps - 1)) + 0.08 * cos(4 * M_PI * i / (num_taps - 1));
+        taps[i] = sinc * w;
+        sum += taps[i];
+    }
+    for (auto &h : taps) h /= sum;
+    return taps;
+}
+
+void PlanarFirDecimator::configure(size_t decimation, size_t num_taps, double cutoff) {
+    decim = decimation;
+    taps = lowpassTaps(num_taps, cutoff);
+    std::reverse(taps.begin(), taps.end()); // Oldest sample first
+    buf.clear();
+    buf.resize(num_taps - 1);
+    phase = 0;
+}
+
+void PlanarFirDecimator::process(const float *in_i, const float *in_q, size_t n, PlanarSamples &out) {
+    size_t len = taps.size(), keep = len - 1;
+    buf.resize(keep + n);
+    std::copy(in_i, in_i + n, buf.i.begin() + keep);
+    std::copy(in_q, in_q + n, buf.q.begin() + keep);
+
+    // Input k is the newest sample of the window x[k, k + len)
+    const float *h = taps.data(), *xi = buf.i.data(), *xq = buf.q.data();
+    for (size_t k = decim - 1 - phase; k < n; k += decim) {
+        out.i.push_back(dot(h, xi + k, len));
+        out.q.push_back(dot(h, xq + k, len));
+    }
+    phase = (phase + n) % decim;
+
+    std::copy(buf.i.end() - keep, buf.i.end(), buf.i.begin());
+    std::copy(buf.q.end() - keep, buf.q.end(), buf.q.begin());
+    buf.resize(keep);
+}
+
+__attribute__((noinline)) float PlanarFirDecimator::dot(const float *t, const float *x, size_t len) {
+    float acc[8] = {};
+    size_t j = 0;
+    for (; j + 8 <= len; j += 8)
+        for (size_t l = 0; l < 8; l++) acc[l] += t[j + l] * x[j + l];
+    for (; j < len; j++) acc[0] += t[j] * x[j];
+    return std::accumulate(acc, acc + 8, 0.0f);
+}
@@ -0,0 +1,221 @@
+#include "dpd.h"
+
+#include <algorithm>
+#include <cmath>
+
+void dpdBasis(const std::complex<float> *x, size_t n, int orders, std::vector<float> &re, std::vector<float> &im) {
+    re.resize(orders * n);
+    im.resize(orders * n);
+    const float *xf = reinterpret_cast<const float *>(x);
+    float *r0 = re.data(), *i0 = im.data();
+    for (size_t i = 0; i < n; i++) {
+        r0[i] = xf[2 * i];
+        i0[i] = xf[2 * i + 1];
+    }
+    for (int k = 1; k < orders; k++) {
+        const float *rp = re.data() + (k - 1) * n, *ip = im.data() + (k - 1) * n;
+        float *rk = re.data() + k * n, *ik = im.data() + k * n;
+        for (size_t i = 0; i < n; i++) {
+            float mag2 = r0[i] * r0[i] + i0[i] * i0[i];
+            rk[i] = rp[i] * mag2;
+            ik[i] = ip[i] * mag2;
+        }
+    }
+}
+
+void Predistorter::process(std::complex<float> *x, size_t n) {
+    if (!current) return;
+    const DpdModel &m = *current;
+    size_t h = hist.size(), len = h + n;
+    ext.resize(len);
+    std::copy(hist.begin(), hist.end(), ext.begin());
+    std::copy(x, x + n, ext.begin() + h);
+    dpdBasis(ext.data(), len, m.orders, bre, bim);
+
+    out_re.assign(n, 0.0f);
+    out_im.assign(n, 0.0f);
+    for (int k = 0; k < m.orders; k++) {
+        for (int d = 0; d < m.memory; d++) {
+            float ar = m.coeffs[k * m.memory + d].real(), ai = m.coeffs[k * m.memory + d].imag();
+            const float *r = bre.data() + k * len + h - d, *i = bim.data() + k * len + h - d;
+            for (size_t j = 0; j < n; j++) {
+                out_re[j] += ar * r[j] - ai * i[j];
+                out_im[j] += ar * i[j] + ai * r[j];
+            }
+        }
+    }
+    for (size_t j = 0; j < n; j++) x[j] = std::complex<float>(out_re[j], out_im[j]);
+    std::copy(ext.end() - h, ext.end(), hist.begin());
+}
+
+DpdTrainer::~DpdTrainer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+void DpdTrainer::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::atomic_store(&current, DpdModelRef(std::make_shared<const DpdModel>(DpdModel::identity(orders, memory))));
+    status = {0, 0, 0.0};
+    gain = 0.0f;
+    generation++;
+}
+
+bool DpdTrainer::submit(std::vector<std::complex<float>> clean, std::vector<std::complex<float>> sent,
+                        std::vector<std::complex<float>> rx) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending || busy) return false;
+        job = {std::move(clean), std::move(sent), std::move(rx)};
+        pending = true;
+    }
+    cv.notify_one();
+    return true;
+}
+
+void DpdTrainer::fitLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return quit || pending; });
+        if (quit) return;
+        Capture c = std::move(job);
+        pending = false;
+        busy = true;
+        std::complex<float> g = gain;
+        uint64_t gen = generation;
+        lock.unlock();
+
+        size_t lag = align(c.sent, c.rx, g);
+        size_t n = c.rx.size();
+        const std::complex<float> *clean = c.clean.data() + lag, *sent = c.sent.data() + lag;
+        if (g == 0.0f) g = linearGain(clean, c.rx.data(), n);
+
+        // A capture that doesn't look like the TX (RX tuned elsewhere,
+        // nothing transmitted) would only teach the model noise
+        if (coherence(sent, c.rx.data(), n) < 0.5) {
+            lock.lock();
+            busy = false;
+            continue;
+        }
+
+        std::vector<std::complex<float>> y(n);
+        for (size_t i = 0; i < n; i++) y[i] = c.rx[i] / g;
+        double err = 0, ref = 0;
+        for (size_t i = 0; i < n; i++) {
+            err += std::norm(y[i] - clean[i]);
+            ref += std::norm(clean[i]);
+        }
+
+        std::vector<std::complex<float>> w;
+        bool ok = fit(y.data(), sent, n, w);
+
+        lock.lock();
+        busy = false;
+        if (!ok || gen != generation) continue;
+        std::atomic_store(&current, DpdModelRef(std::make_shared<const DpdModel>(DpdModel{orders, memory, w})));
+        if (gain == 0.0f) gain = g;
+        status = {status.fits + 1, lag, 10.0 * log10((err + 1e-30) / (ref + 1e-30))};
+    }
+}
+
+size_t DpdTrainer::align(const std::vector<std::complex<float>> &record, const std::vector<std::complex<float>> &capture,
+                         std::complex<float> expected_gain) {
+    size_t n = 1;
+    while (n < record.size() + capture.size()) n *= 2;
+    if (fft.size() != n) fft.resize(n);
+    xa.assign(n, 0.0f);
+    xb.assign(n, 0.0f);
+    std::copy(record.begin(), record.end(), xa.begin());
+    std::copy(capture.begin(), capture.end(), xb.begin());
+    fft.forward(xa.data());
+    fft.forward(xb.data());
+    for (size_t k = 0; k < n; k++) xa[k] *= std::conj(xb[k]);
+    fft.inverse(xa.data());
+    // xa[l] ~ conj(gain) * energy at the true lag
+    auto score = [&](size_t l) {
+        return expected_gain == 0.0f ? std::norm(xa[l]) : (xa[l] * expected_gain).real();
+    };
+    size_t best = 0;
+    for (size_t l = 1; l + capture.size() <= record.size(); l++) {
+        if (score(l) > score(best)) best = l;
+    }
+    return best;
+}
+
+double DpdTrainer::coherence(const std::complex<float> *x, const std::complex<float> *y, size_t n) {
+    std::complex<double> xy = 0;
+    double xx = 1e-30, yy = 1e-30;
+    for (size_t i = 0; i < n; i++) {
+        xy += std::complex<double>(y[i]) * std::conj(std::complex<double>(x[i]));
+        xx += std::norm(x[i]);
+        yy += std::norm(y[i]);
+    }
+    return std::norm(xy) / (xx * yy);
+}
+
+std::complex<float> DpdTrainer::linearGain(const std::complex<float> *x, const std::complex<float> *y, size_t n) {
+    std::complex<double> num = 0;
+    double den = 1e-30;
+    for (size_t i = 0; i < n; i++) {
+        num += std::complex<double>(y[i]) * std::conj(std::complex<double>(x[i]));
+        den += std::norm(x[i]);
+    }
+    return std::complex<float>(num / den);
+}
+
+bool DpdTrainer::fit(const std::complex<float> *in, const std::complex<float> *target, size_t n,
+                     std::vector<std::complex<float>> &w) {
+    size_t h = memory - 1;
+    if (n <= h) return false;
+    size_t p = orders * memory, rows = n - h;
+    dpdBasis(in, n, orders, bre, bim);
+
+    auto col = [&](size_t c, size_t row) {
+        size_t k = c / memory, d = c % memory;
+        size_t idx = k * n + h + row - d;
+        return std::complex<double>(bre[idx], bim[idx]);
+    };
+    std::vector<std::complex<double>> A(p * p, 0.0), b(p, 0.0);
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t i = 0; i < p; i++) {
+            std::complex<double> ci = std::conj(col(i, r));
+            b[i] += ci * std::complex<double>(target[h + r]);
+            for (size_t j = i; j < p; j++) A[i * p + j] += ci * col(j, r);
+        }
+    }
+    double trace = 0;
+    for (size_t i = 0; i < p; i++) {
+        for (size_t j = 0; j < i; j++) A[i * p + j] = std::conj(A[j * p + i]);
+        trace += A[i * p + i].real();
+    }
+    for (size_t i = 0; i < p; i++) A[i * p + i] += 1e-6 * trace / p;
+
+    // Gaussian elimination with partial pivoting
+    for (size_t c = 0; c < p; c++) {
+        size_t piv = c;
+        for (size_t r = c + 1; r < p; r++) if (std::abs(A[r * p + c]) > std::abs(A[piv * p + c])) piv = r;
+        if (std::abs(A[piv * p + c]) < 1e-20) return false;
+        if (piv != c) {
+            for (size_t j = 0; j < p; j++) std::swap(A[c * p + j], A[piv * p + j]);
+            std::swap(b[c], b[piv]);
+        }
+        for (size_t r = c + 1; r < p; r++) {
+            std::complex<double> f = A[r * p + c] / A[c * p + c];
+            for (size_t j = c; j < p; j++) A[r * p + j] -= f * A[c * p + j];
+            b[r] -= f * b[c];
+        }
+    }
+    w.assign(p, 0.0f);
+    std::vector<std::complex<double>> x(p);
+    for (size_t c = p; c-- > 0;) {
+        std::complex<double> s = b[c];
+        for (size_t j = c + 1; j < p; j++) s -= A[c * p + j] * x[j];
+        x[c] = s / A[c * p + c];
+        w[c] = std::complex<float>(x[c]);
+    }
+    return true;
+}
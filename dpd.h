@@ -0,0 +1,126 @@
+#pragma once
+
+#include "fft.h"
+
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Memory polynomial: y[n] = sum over k, m of a[k][m] * x[n-m] * |x[n-m]|^(2k),
+// i.e. odd nonlinearity orders 1, 3, 5, ... and 'memory' taps per order.
+struct DpdModel {
+    int orders = 3;
+    int memory = 3;
+    std::vector<std::complex<float>> coeffs; // [k * memory + m]
+
+    static DpdModel identity(int orders, int memory) {
+        DpdModel m{orders, memory, std::vector<std::complex<float>>(orders * memory, 0.0f)};
+        m.coeffs[0] = 1.0f;
+        return m;
+    }
+};
+using DpdModelRef = std::shared_ptr<const DpdModel>;
+
+// Basis terms x|x|^(2k) for k < orders, planar so that every loop here and in
+// the users vectorizes: term k of sample i is (re[k * n + i], im[k * n + i])
+void dpdBasis(const std::complex<float> *x, size_t n, int orders, std::vector<float> &re, std::vector<float> &im);
+
+// Applies a DpdModel in place, block by block. The model is swapped only
+// between blocks; the memory taps carry across them.
+class Predistorter {
+public:
+    void setModel(DpdModelRef m) {
+        if (m == current) return;
+        if (!current || !m || m->memory != current->memory) hist.assign(m ? m->memory - 1 : 0, 0.0f);
+        current = std::move(m);
+    }
+
+    void process(std::complex<float> *x, size_t n);
+
+private:
+    DpdModelRef current;
+    std::vector<std::complex<float>> hist, ext;
+    std::vector<float> bre, bim, out_re, out_im;
+};
+
+// Identifies the predistorter from loopback captures on a helper thread
+// (indirect learning): each capture is time-aligned to the TX record, the
+// RX is normalized by the linear gain, and a postdistorter mapping RX back
+// to what was sent is fitted by least squares. Its coefficients become the
+// next predistorter, published as a new immutable model.
+class DpdTrainer {
+public:
+    struct Status {
+        uint64_t fits;
+        size_t lag;        // TX record samples ahead of the RX capture
+        double error_db;   // Residual of RX vs. the undistorted signal, relative to it
+    };
+
+    DpdTrainer(int orders, int memory) : orders(orders), memory(memory) {
+        reset();
+        thread = std::thread(&DpdTrainer::fitLoop, this);
+    }
+
+    ~DpdTrainer();
+
+    // A fit already running when this is called is discarded
+    void reset();
+
+    DpdModelRef model() const { return std::atomic_load(&current); }
+
+    Status lastStatus() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return status;
+    }
+
+    // 'clean' is the signal before predistortion and 'sent' after it, over the
+    // same TX record; 'rx' is a shorter capture somewhere inside that record.
+    // Returns false (and drops the capture) while a fit is still running.
+    bool submit(std::vector<std::complex<float>> clean, std::vector<std::complex<float>> sent,
+                std::vector<std::complex<float>> rx);
+
+private:
+    struct Capture {
+        std::vector<std::complex<float>> clean, sent, rx;
+    };
+
+    const int orders, memory;
+    DpdModelRef current;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    Capture job;
+    bool pending = false, busy = false, quit = false;
+    uint64_t generation = 0; // Bumped by reset()
+    Status status{0, 0, 0.0};
+    std::complex<float> gain = 0.0f; // Linear target gain, fixed by the first fit
+
+    FFT fft;
+    std::vector<std::complex<float>> xa, xb;
+    std::vector<float> bre, bim;
+
+    std::thread thread; // Declared last so everything above exists before it runs
+
+    void fitLoop();
+
+    // Offset into 'record' where 'capture' matches best (FFT cross-correlation).
+    // Once the loop gain is known the match must also have its phase, which
+    // keeps periodic signals from locking half a period off.
+    size_t align(const std::vector<std::complex<float>> &record, const std::vector<std::complex<float>> &capture,
+                 std::complex<float> expected_gain);
+
+    // |<x, y>|^2 / (|x|^2 |y|^2), 1 for a perfect linear match
+    static double coherence(const std::complex<float> *x, const std::complex<float> *y, size_t n);
+
+    static std::complex<float> linearGain(const std::complex<float> *x, const std::complex<float> *y, size_t n);
+
+    // Least squares for w in basis(in) * w = target, via the normal
+    // equations with a little diagonal loading
+    bool fit(const std::complex<float> *in, const std::complex<float> *target, size_t n,
+             std::vector<std::complex<float>> &w);
+};
@@ -0,0 +1,158 @@
+#include "event_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+bool EventStore::open(const std::string &path) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    FileHeader h;
+    if (pread(fd, &h, sizeof(h), 0) == ssize_t(sizeof(h))) {
+        if (memcmp(h.magic, magic, sizeof(h.magic)) != 0 || h.block_rows != block_rows) {
+            close();
+            return false;
+        }
+        header = h;
+    } else {
+        memcpy(header.magic, magic, sizeof(header.magic));
+        header.block_rows = block_rows;
+        writeHeader();
+    }
+
+    size_t full = header.rows / block_rows;
+    remap(full + 1);
+    for (size_t b = 0; b < full; b++) indexBlock(b);
+    if (header.rows % block_rows) {
+        const BlockHeader *bh = blockHeader(full);
+        for (uint32_t i = 0; i < bh->rows; i++) tail.push_back(row(full, i));
+    }
+    return true;
+}
+
+void EventStore::close() {
+    if (fd < 0) return;
+    sync();
+    // The mapping grows the file ahead of the data; give that back
+    bool trimmed = ftruncate(fd, blockOffset((header.rows + block_rows - 1) / block_rows)) == 0;
+    (void)trimmed; // Only wastes disk space if it fails
+    if (map) munmap(map, mapped);
+    map = nullptr;
+    mapped = 0;
+    ::close(fd);
+    fd = -1;
+    header = FileHeader();
+    tail.clear();
+    t_min.clear();
+    t_max_prefix.clear();
+    zones.clear();
+}
+
+size_t EventStore::query(const Query &q, std::vector<StoredEvent> &out, QueryStats *stats) {
+    size_t found = 0, blocks_read = 0, scanned = 0;
+    size_t full = fullBlocks();
+    remap(full);
+
+    // First block that can reach t0; stop once blocks start past t1
+    size_t b = std::lower_bound(t_max_prefix.begin(), t_max_prefix.end(), q.t0) - t_max_prefix.begin();
+    for (; b < full && found < q.limit; b++) {
+        if (t_min[b] > q.t1 + header.disorder_s) break;
+        const Zone &z = zones[b];
+        if (z.t_max < q.t0 || z.t_min > q.t1 || z.hz_max < q.lo_hz || z.hz_min > q.hi_hz) continue;
+        if (q.kind >= 0 && !(z.kinds & (1u << q.kind))) continue;
+        blocks_read++;
+        const double *time = column<double>(b, 0);
+        const double *lo = column<double>(b, 1);
+        const double *hi = column<double>(b, 2);
+        const uint8_t *kind = column<uint8_t>(b, 5);
+        auto match = [&](size_t i) {
+            scanned++;
+            if (hi[i] < q.lo_hz || lo[i] > q.hi_hz || (q.kind >= 0 && kind[i] != q.kind)) return;
+            if (time[i] < q.t0 || time[i] > q.t1) return;
+            out.push_back(row(b, i));
+            found++;
+        };
+        if (z.t_min >= q.t0 && z.t_max <= q.t1) {
+            // Only rows starting in [lo_hz - widest, hi_hz] can overlap the band
+            const uint16_t *order = column<uint16_t>(b, 6);
+            double widest = blockHeader(b)->widest_hz;
+            auto first = std::lower_bound(order, order + block_rows, q.lo_hz - widest,
+                                          [&](uint16_t i, double f) { return lo[i] < f; });
+            for (auto it = first; it < order + block_rows && lo[*it] <= q.hi_hz && found < q.limit; ++it) match(*it);
+        } else {
+            size_t i = std::lower_bound(time, time + block_rows, q.t0) - time;
+            for (; i < block_rows && time[i] <= q.t1 && found < q.limit; i++) match(i);
+        }
+    }
+    for (const auto &e : tail) {
+        if (found >= q.limit) break;
+        scanned++;
+        if (e.time_s < q.t0 || e.time_s > q.t1 || e.hi_hz < q.lo_hz || e.lo_hz > q.hi_hz) continue;
+        if (q.kind >= 0 && e.kind != q.kind) continue;
+        out.push_back(e);
+        found++;
+    }
+    std::stable_sort(out.end() - found, out.end(),
+                     [](const StoredEvent &a, const StoredEvent &c) { return a.time_s < c.time_s; });
+    if (stats) *stats = {full, blocks_read, scanned};
+    return found;
+}
+
+void EventStore::remap(size_t blocks) {
+    size_t need = blockOffset(blocks);
+    if (need <= mapped) return;
+    if (map) munmap(map, mapped);
+    size_t len = std::max(need, mapped * 2);
+    if (size_t(lseek(fd, 0, SEEK_END)) < len && ftruncate(fd, len) != 0) len = need;
+    void *p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    map = p == MAP_FAILED ? nullptr : static_cast<uint8_t *>(p);
+    mapped = map ? len : 0;
+}
+
+void EventStore::indexBlock(size_t b) {
+    const BlockHeader *bh = blockHeader(b);
+    double prev_max = t_max_prefix.empty() ? -INFINITY : t_max_prefix.back();
+    if (bh->t_min < prev_max) header.disorder_s = std::max(header.disorder_s, prev_max - bh->t_min);
+    t_min.push_back(bh->t_min);
+    t_max_prefix.push_back(std::max(prev_max, bh->t_max));
+    zones.push_back({bh->t_min, bh->t_max, bh->hz_min, bh->hz_max, bh->kinds});
+}
+
+void EventStore::writeTail() {
+    std::sort(tail.begin(), tail.end(), [](const StoredEvent &a, const StoredEvent &c) { return a.time_s < c.time_s; });
+    std::vector<uint8_t> buf(block_bytes);
+    BlockHeader bh{uint32_t(tail.size()), 0, INFINITY, -INFINITY, INFINITY, -INFINITY, 0};
+    std::vector<uint16_t> order(tail.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint16_t a, uint16_t c) { return tail[a].lo_hz < tail[c].lo_hz; });
+    memcpy(&buf[column_offset[6]], order.data(), order.size() * sizeof(uint16_t));
+    for (size_t i = 0; i < tail.size(); i++) {
+        const StoredEvent &e = tail[i];
+        memcpy(&buf[column_offset[0] + 8 * i], &e.time_s, 8);
+        memcpy(&buf[column_offset[1] + 8 * i], &e.lo_hz, 8);
+        memcpy(&buf[column_offset[2] + 8 * i], &e.hi_hz, 8);
+        memcpy(&buf[column_offset[3] + 4 * i], &e.level, 4);
+        memcpy(&buf[column_offset[4] + 4 * i], &e.floor_db, 4);
+        buf[column_offset[5] + i] = e.kind;
+        bh.kinds |= 1u << e.kind;
+        bh.t_min = std::min(bh.t_min, e.time_s);
+        bh.t_max = std::max(bh.t_max, e.time_s);
+        bh.hz_min = std::min(bh.hz_min, e.lo_hz);
+        bh.hz_max = std::max(bh.hz_max, e.hi_hz);
+        bh.widest_hz = std::max(bh.widest_hz, e.hi_hz - e.lo_hz);
+    }
+    memcpy(buf.data(), &bh, sizeof(bh));
+    size_t b = fullBlocks();
+    if (pwrite(fd, buf.data(), block_bytes, blockOffset(b)) != ssize_t(block_bytes)) return;
+    header.rows = b * block_rows + tail.size();
+    if (tail.size() == block_rows) {
+        remap(b + 1);
+        indexBlock(b);
+        tail.clear();
+    }
+    writeHeader();
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// One row of the event database
+struct StoredEvent {
+    enum Kind : uint8_t { Energy = 0, Preamble = 1 };
+    double time_s;  // Unix time
+    double lo_hz;   // RF extent; equal for point events
+    double hi_hz;
+    float level;    // Peak dBFS (energy) or normalized correlation (preamble)
+    float floor_db; // Noise floor (energy)
+    uint8_t kind;
+};
+
+// Append-only, memory-mapped event database. Rows are stored in columnar
+// blocks of block_rows, each sorted by time and carrying a second ordering by
+// frequency, with a sparse index per block (time and frequency ranges, kinds
+// present) kept in memory. A query binary searches the running maximum of
+// block end times for its first block and skips blocks whose zone maps miss
+// it. Blocks that lie inside the time range are searched by frequency, the
+// ones at its edges by time. Late rows are allowed: the file records how far
+// any block reaches back before its predecessors, and queries keep scanning
+// by that much.
+// Rows not yet in a full block live in the tail; sync() writes the tail as a
+// partial block, which later appends overwrite in place.
+class EventStore {
+public:
+    static constexpr size_t block_rows = 1024;
+
+    struct Query {
+        double t0 = -INFINITY, t1 = INFINITY;
+        double lo_hz = -INFINITY, hi_hz = INFINITY; // Rows overlapping this band match
+        int kind = -1; // StoredEvent::Kind, -1 for all
+        size_t limit = SIZE_MAX;
+    };
+
+    struct QueryStats {
+        size_t blocks = 0;       // Full blocks in the file
+        size_t blocks_read = 0;  // Blocks whose rows were looked at
+        size_t rows_scanned = 0;
+    };
+
+    ~EventStore() { close(); }
+
+    bool open(const std::string &path);
+
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    size_t size() const { return fullBlocks() * block_rows + tail.size(); }
+    double firstTime() const { return header.first_time; }
+
+    void append(const StoredEvent &e) {
+        if (fd < 0) return;
+        if (size() == 0 || e.time_s < header.first_time) header.first_time = e.time_s;
+        tail.push_back(e);
+        if (tail.size() == block_rows) writeTail();
+    }
+
+    // Makes everything appended so far durable
+    void sync() {
+        if (fd < 0 || tail.empty()) return;
+        writeTail();
+    }
+
+    size_t query(const Query &q, std::vector<StoredEvent> &out, QueryStats *stats = nullptr);
+
+private:
+    static constexpr char magic[8] = {'E', 'V', 'D', 'B', 0, 0, 0, 1};
+    static constexpr size_t header_bytes = 4096;
+    static constexpr size_t block_header_bytes = 64;
+    // Column byte offsets within a block: time, lo, hi, level, floor, kind,
+    // then the row numbers in lo_hz order
+    static constexpr size_t column_offset[7] = {
+        block_header_bytes,
+        block_header_bytes + 8 * block_rows,
+        block_header_bytes + 16 * block_rows,
+        block_header_bytes + 24 * block_rows,
+        block_header_bytes + 28 * block_rows,
+        block_header_bytes + 32 * block_rows,
+        block_header_bytes + 33 * block_rows,
+    };
+    static constexpr size_t block_bytes = (block_header_bytes + 35 * block_rows + 4095) / 4096 * 4096;
+
+    struct FileHeader {
+        char magic[8] = {};
+        uint32_t block_rows = 0;
+        uint32_t reserved = 0;
+        uint64_t rows = 0;        // Durable rows, including a trailing partial block
+        double disorder_s = 0;    // Furthest any block starts before an earlier block ends
+        double first_time = 0;
+    };
+
+    struct BlockHeader {
+        uint32_t rows;
+        uint32_t kinds; // Bit per StoredEvent::Kind present
+        double t_min, t_max;
+        double hz_min, hz_max;
+        double widest_hz; // Largest hi_hz - lo_hz in the block
+    };
+
+    struct Zone {
+        double t_min, t_max, hz_min, hz_max;
+        uint32_t kinds;
+    };
+
+    int fd = -1;
+    uint8_t *map = nullptr;
+    size_t mapped = 0;
+    FileHeader header;
+    std::vector<StoredEvent> tail;
+    std::vector<double> t_min, t_max_prefix; // Sparse time index, one entry per full block
+    std::vector<Zone> zones;
+
+    size_t fullBlocks() const { return t_min.size(); }
+    static size_t blockOffset(size_t b) { return header_bytes + b * block_bytes; }
+
+    template <typename T> const T *column(size_t b, int c) const {
+        return reinterpret_cast<const T *>(map + blockOffset(b) + column_offset[c]);
+    }
+    const BlockHeader *blockHeader(size_t b) const { return reinterpret_cast<const BlockHeader *>(map + blockOffset(b)); }
+
+    StoredEvent row(size_t b, size_t i) const {
+        return {column<double>(b, 0)[i], column<double>(b, 1)[i], column<double>(b, 2)[i],
+                column<float>(b, 3)[i], column<float>(b, 4)[i], column<uint8_t>(b, 5)[i]};
+    }
+
+    // Maps at least 'blocks' blocks; the mapping only ever grows
+    void remap(size_t blocks);
+
+    void indexBlock(size_t b);
+
+    // Writes the tail into the first non-full block slot; a full tail
+    // becomes a block of the index
+    void writeTail();
+
+    bool writeHeader() { return pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)); }
+};
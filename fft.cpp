@@ -0,0 +1,43 @@
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FFT::resize(size_t n) {
+    len = n;
+    twiddle.resize(n / 2);
+    for (size_t k = 0; k < n / 2; k++) {
+        double a = -2.0 * M_PI * k / n;
+        twiddle[k] = std::complex<float>(cos(a), sin(a));
+    }
+    bitrev.resize(n);
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n) bits++;
+    for (size_t i = 0; i < n; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) if (i & (size_t(1) << b)) r |= size_t(1) << (bits - 1 - b);
+        bitrev[i] = r;
+    }
+}
+
+void FFT::transform(std::complex<float> *x, bool inv) const {
+    for (size_t i = 0; i < len; i++) {
+        if (i < bitrev[i]) std::swap(x[i], x[bitrev[i]]);
+    }
+    for (size_t half = 1; half < len; half *= 2) {
+        size_t step = len / (half * 2);
+        for (size_t i = 0; i < len; i += half * 2) {
+            for (size_t j = 0; j < half; j++) {
+                float wr = twiddle[j * step].real();
+                float wi = inv ? -twiddle[j * step].imag() : twiddle[j * step].imag();
+                // Multiplied out by hand: std::complex operator* goes through
+                // the Inf/NaN-checking __mulsc3 call without -ffast-math
+                std::complex<float> b = x[i + j + half];
+                std::complex<float> u = x[i + j];
+                std::complex<float> v(b.real() * wr - b.imag() * wi, b.real() * wi + b.imag() * wr);
+                x[i + j] = u + v;
+                x[i + j + half] = u - v;
+            }
+        }
+    }
+}
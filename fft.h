@@ -0,0 +1,26 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Radix-2 in-place FFT. Twiddles and the bit-reversal table are computed once
+// per size so the per-frame cost is just the butterflies.
+class FFT {
+public:
+    explicit FFT(size_t n = 0) { resize(n); }
+
+    void resize(size_t n);
+
+    size_t size() const { return len; }
+
+    void forward(std::complex<float> *x) const { transform(x, false); }
+    void inverse(std::complex<float> *x) const { transform(x, true); } // Unscaled
+
+private:
+    size_t len = 0;
+    std::vector<std::complex<float>> twiddle;
+    std::vector<size_t> bitrev;
+
+    void transform(std::complex<float> *x, bool inv) const;
+};
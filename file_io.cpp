@@ -0,0 +1,41 @@
+#include "file_io.h"
+
+#include <cstdio>
+
+bool loadFc32(const std::string &path, std::vector<std::complex<float>> &out) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    std::streamsize bytes = f.tellg();
+    f.seekg(0);
+    out.resize(bytes / sizeof(std::complex<float>));
+    return bool(f.read(reinterpret_cast<char *>(out.data()), out.size() * sizeof(std::complex<float>)));
+}
+
+bool openCsvLog(std::ofstream &out, const std::string &path, const std::string &header) {
+    std::string first;
+    if (std::getline(std::ifstream(path), first) && first != header) {
+        size_t dot = path.rfind('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos) dot = path.size();
+        for (unsigned n = 1;; n++) {
+            std::string aside = path.substr(0, dot) + "." + std::to_string(n) + path.substr(dot);
+            if (!std::ifstream(aside)) {
+                if (std::rename(path.c_str(), aside.c_str()) != 0) return false;
+                break;
+            }
+        }
+    }
+    out.open(path, std::ios::app);
+    if (!out) return false;
+    out.seekp(0, std::ios::end);
+    if (out.tellp() == 0) out << header << "\n";
+    return true;
+}
+
+std::string sigmfField(const std::string &json, const std::string &key) {
+    size_t at = json.find("\"" + key + "\"");
+    if (at == std::string::npos || (at = json.find(':', at + key.size() + 2)) == std::string::npos) return "";
+    at = json.find_first_not_of(" \t\r\n", at + 1);
+    if (at == std::string::npos) return "";
+    if (json[at] == '"') return json.substr(at + 1, json.find('"', at + 1) - at - 1);
+    return json.substr(at, json.find_first_of(",}\r\n", at) - at);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <complex>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Raw interleaved complex float32 (the UHD "fc32" layout on disk)
+bool loadFc32(const std::string &path, std::vector<std::complex<float>> &out);
+
+// Opens a CSV log for appending and writes the header only into an empty
+// file, so re-enabling a log continues it instead of repeating the header.
+// A file written with different columns is moved aside to "name.N.csv"
+// first, so rows of two layouts never share one file.
+bool openCsvLog(std::ofstream &out, const std::string &path, const std::string &header);
+
+// Value of the first "key" in SigMF metadata, without quotes; empty if absent.
+// Enough for the flat fields this program writes and reads back.
+std::string sigmfField(const std::string &json, const std::string &key);
@@ -0,0 +1,87 @@
+#include "fm_demodulator.h"
+
+void FmDemodulator::configure(Mode m, double input_rate, double offset_hz) {
+    mode = m;
+    offset = offset_hz;
+    size_t chan_decim = (m == Wideband) ? 4 : 20;
+    size_t audio_decim = 20 / chan_decim;
+    chan_rate = input_rate / chan_decim;
+    audio_rate = chan_rate / audio_decim;
+
+    double chan_bw = (m == Wideband) ? 100e3 : 8e3; // One-sided
+    chan_filter.configure(chan_decim, 8 * chan_decim + 1, chan_bw / input_rate);
+    audio_filter.configure(audio_decim, 8 * audio_decim + 1, 0.4 / audio_decim);
+
+    double deviation = (m == Wideband) ? 75e3 : 5e3;
+    gain = chan_rate / (2 * M_PI * deviation);
+    double tau = (m == Wideband) ? 75e-6 : 0.0;
+    deemph_alpha = (tau > 0) ? 1.0 - exp(-1.0 / (chan_rate * tau)) : 1.0;
+
+    double w = -2.0 * M_PI * offset_hz / input_rate;
+    rot = 1.0f;
+    rot_step = std::complex<float>(cos(w), sin(w));
+    last = 1.0f;
+    deemph = 0.0f;
+}
+
+void FmDemodulator::process(const float *in_i, const float *in_q, size_t n, std::vector<float> &audio) {
+    // Mix the channel to DC with eight phasors, each eight samples apart,
+    // so the loop vectorizes; they are renormalized once per block
+    mixed.resize(n);
+    float lane_r[8], lane_i[8];
+    std::complex<float> p = rot;
+    for (size_t l = 0; l < 8; l++, p *= rot_step) {
+        lane_r[l] = p.real();
+        lane_i[l] = p.imag();
+    }
+    std::complex<float> step8 = std::pow(rot_step, 8);
+    float sr = step8.real(), si = step8.imag();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        for (size_t l = 0; l < 8; l++) {
+            float x = in_i[k + l], y = in_q[k + l];
+            mixed.i[k + l] = x * lane_r[l] - y * lane_i[l];
+            mixed.q[k + l] = x * lane_i[l] + y * lane_r[l];
+            float r = lane_r[l] * sr - lane_i[l] * si;
+            lane_i[l] = lane_r[l] * si + lane_i[l] * sr;
+            lane_r[l] = r;
+        }
+    }
+    for (size_t l = 0; k + l < n; l++) {
+        float x = in_i[k + l], y = in_q[k + l];
+        mixed.i[k + l] = x * lane_r[l] - y * lane_i[l];
+        mixed.q[k + l] = x * lane_i[l] + y * lane_r[l];
+    }
+    rot = std::complex<float>(lane_r[n - k], lane_i[n - k]);
+    rot /= std::abs(rot);
+
+    baseband.clear();
+    chan_filter.process(mixed.i.data(), mixed.q.data(), n, baseband);
+    size_t m = baseband.size();
+    if (m == 0) return;
+
+    // Conjugate-multiply with the previous sample, then one fast atan2
+    // per sample
+    re.resize(m);
+    im.resize(m);
+    const float *bi = baseband.i.data(), *bq = baseband.q.data();
+    re[0] = bi[0] * last.real() + bq[0] * last.imag();
+    im[0] = bq[0] * last.real() - bi[0] * last.imag();
+    for (size_t i = 1; i < m; i++) {
+        re[i] = bi[i] * bi[i - 1] + bq[i] * bq[i - 1];
+        im[i] = bq[i] * bi[i - 1] - bi[i] * bq[i - 1];
+    }
+    last = std::complex<float>(bi[m - 1], bq[m - 1]);
+
+    demod.resize(m);
+    for (size_t i = 0; i < m; i++) demod[i] = fastAtan2(im[i], re[i]) * gain;
+
+    float y = deemph;
+    for (size_t i = 0; i < m; i++) {
+        y += deemph_alpha * (demod[i] - y);
+        demod[i] = y;
+    }
+    deemph = y;
+
+    audio_filter.process(demod.data(), m, audio);
+}
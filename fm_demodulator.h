@@ -0,0 +1,52 @@
+#pragma once
+
+#include "decimators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Polynomial atan2, max error ~1e-5 rad. Written with selects instead of
+// branches so loops over it vectorize.
+inline float fastAtan2(float y, float x) {
+    float ax = fabsf(x), ay = fabsf(y);
+    float a = std::min(ax, ay) / (std::max(ax, ay) + 1e-30f);
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    r = (ay > ax) ? 1.57079637f - r : r;
+    r = (x < 0) ? 3.14159274f - r : r;
+    return (y < 0) ? -r : r;
+}
+
+// DDC -> quadrature discriminator -> de-emphasis -> audio decimation.
+// Wideband is broadcast FM (75 kHz deviation, 75 us de-emphasis), narrowband
+// is 5 kHz deviation voice FM. Both produce audio at input_rate / 20.
+class FmDemodulator {
+public:
+    enum Mode { Wideband = 0, Narrowband = 1 };
+
+    void configure(Mode m, double input_rate, double offset_hz);
+
+    Mode currentMode() const { return mode; }
+    double currentOffset() const { return offset; }
+    double audioRate() const { return audio_rate; }
+
+    // Appends demodulated audio (nominally +/-1 at full deviation). Input is
+    // split I/Q.
+    void process(const float *in_i, const float *in_q, size_t n, std::vector<float> &audio);
+
+private:
+    Mode mode = Wideband;
+    double offset = 0;
+    double chan_rate = 0, audio_rate = 0;
+    float gain = 1.0f;
+    float deemph_alpha = 1.0f;
+    float deemph = 0.0f;
+    std::complex<float> rot = 1.0f, rot_step = 1.0f, last = 1.0f;
+    PlanarFirDecimator chan_filter;
+    FirDecimator<float> audio_filter;
+    PlanarSamples mixed, baseband;
+    std::vector<float> re, im, demod;
+};
@@ -0,0 +1,63 @@
+#include "frame_history.h"
+
+#include <algorithm>
+
+void FrameHistory::setDepth(size_t frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    depth = cap = frames;
+    recent.clear();
+    parked.clear();
+    spectra.clear();
+    frozen = false;
+}
+
+void FrameHistory::push(FrameRef f) {
+    parked.push_back(std::move(f));
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    for (auto &p : parked) {
+        if (frozen || depth == 0) break;
+        recent.push_back(std::move(p));
+        if (recent.size() > cap) recent.pop_front();
+    }
+    parked.clear();
+}
+
+void FrameHistory::push(SpectrumRef s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frozen || depth == 0) return;
+    spectrum_bytes = s->psd_db.size() * sizeof(float);
+    spectra.push_back(std::move(s));
+    if (spectra.size() > cap) spectra.pop_front();
+}
+
+size_t FrameHistory::shrink(size_t excess) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frozen || spectra.empty()) return 0;
+    size_t freed = 0;
+    while (!spectra.empty() && freed < excess) {
+        freed += spectra.front()->psd_db.size() * sizeof(float);
+        spectra.pop_front();
+    }
+    cap = spectra.size();
+    while (recent.size() > cap) recent.pop_front();
+    return freed;
+}
+
+size_t FrameHistory::grow(size_t headroom) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frozen || cap >= depth || spectrum_bytes == 0) return 0;
+    size_t more = std::min(depth - cap, headroom / spectrum_bytes);
+    cap += more;
+    return more * spectrum_bytes;
+}
+
+FrameHistory::Snapshot FrameHistory::freeze() {
+    std::lock_guard<std::mutex> lock(mutex);
+    frozen = true;
+    Snapshot snap;
+    snap.frames.assign(recent.begin(), recent.end());
+    snap.spectra.assign(spectra.begin(), spectra.end());
+    snap.bytes = bytesLocked();
+    return snap;
+}
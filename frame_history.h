@@ -0,0 +1,83 @@
+#pragma once
+
+#include "analysis_scheduler.h"
+
+#include <complex>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// The last few seconds of RX frames and spectra, kept by reference. Frames
+// share their pooled blocks with the analysis tasks, so recording one costs
+// a refcount and freezing hands out the same pointers instead of a copy.
+// Nothing is recorded while frozen, so the blocks held never exceed the
+// depth the pool was enlarged by.
+class FrameHistory {
+public:
+    struct Snapshot {
+        std::vector<FrameRef> frames;     // Oldest first
+        std::vector<SpectrumRef> spectra; // Oldest first
+        size_t bytes = 0;
+    };
+
+    // Also drops everything held; 0 turns recording off
+    void setDepth(size_t frames);
+
+    // Radio thread only, like setDepth(). It never waits: while the GUI
+    // holds the lock the frame is parked and goes in with the next push.
+    void push(FrameRef f);
+
+    void push(SpectrumRef s);
+
+    // Memory budget hooks. Shrinking lowers the depth actually kept, oldest
+    // first, frames and spectra alike; growing restores it up to the
+    // setDepth() value. Only the spectra are counted: the frames' blocks go
+    // back to the pool, which stays allocated. Nothing moves while frozen.
+    size_t shrink(size_t excess);
+
+    size_t grow(size_t headroom);
+
+    bool shrunk() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cap < depth;
+    }
+
+    // Stops recording until thaw() and returns what was held
+    Snapshot freeze();
+
+    void thaw() {
+        std::lock_guard<std::mutex> lock(mutex);
+        frozen = false;
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytesLocked();
+    }
+
+    // The blocks are counted with the frame pool; this is the rest
+    size_t spectrumBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t b = 0;
+        for (const auto &sp : spectra) b += sp->psd_db.size() * sizeof(float);
+        return b;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::deque<FrameRef> recent;
+    std::vector<FrameRef> parked; // Radio thread only
+    std::deque<SpectrumRef> spectra;
+    size_t depth = 0;
+    size_t cap = 0;            // Depth kept now; below depth when shrunk
+    size_t spectrum_bytes = 0; // Size of the latest spectrum
+    bool frozen = false;
+
+    size_t bytesLocked() const {
+        size_t b = 0;
+        for (const auto &f : recent) b += f->block->capacity * sizeof(std::complex<float>);
+        for (const auto &sp : spectra) b += sp->psd_db.size() * sizeof(float);
+        return b;
+    }
+};
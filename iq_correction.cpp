@@ -0,0 +1,102 @@
+#include "iq_correction.h"
+
+IqCorrection IqCorrection::fromImage(std::complex<double> beta, std::complex<double> dc) {
+    IqCorrection c;
+    c.m11 = float(1.0 + beta.real());
+    c.m12 = float(beta.imag());
+    c.m21 = float(beta.imag());
+    c.m22 = float(1.0 - beta.real());
+    c.dc_i = float(dc.real());
+    c.dc_q = float(dc.imag());
+    return c;
+}
+
+void IqCalibrator::start(const IqCorrection &current, double tone_hz, double rate, float amplitude) {
+    base = current;
+    freq = tone_hz;
+    fs = rate;
+    amp = amplitude;
+    tone_phase = 0.0;
+    stage = Settle0;
+    frames = 0;
+    clearSums();
+    report = {false, NAN, NAN, NAN, NAN};
+}
+
+void IqCalibrator::tone(std::complex<float> *out, size_t n) {
+    double w = 2.0 * M_PI * freq / fs;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = std::polar(amp, float(tone_phase));
+        tone_phase += w;
+    }
+    tone_phase = fmod(tone_phase, 2.0 * M_PI);
+}
+
+bool IqCalibrator::measure(const std::complex<float> *rx, size_t n) {
+    const size_t settle_frames = 10, measure_frames = 8;
+    bool settling = stage == Settle0 || stage == Settle1 || stage == Settle2;
+    if (settling) {
+        if (++frames >= settle_frames) {
+            stage = Stage(stage + 1);
+            frames = 0;
+        }
+        return false;
+    }
+
+    std::complex<double> p, neg, dc;
+    bins(rx, n, p, neg, dc);
+    double p2 = std::norm(p) + 1e-30;
+    image_sum += neg * p / p2;
+    leak_sum += dc;
+    image_pow += std::norm(neg) / p2;
+    leak_pow += std::norm(dc) / p2;
+    if (++frames < measure_frames) return false;
+
+    std::complex<double> image = image_sum / double(measure_frames);
+    std::complex<double> leak = leak_sum / double(measure_frames);
+    double irr = -10.0 * log10(image_pow / measure_frames + 1e-30);
+    double leakage = 10.0 * log10(leak_pow / measure_frames + 1e-30);
+    frames = 0;
+    clearSums();
+
+    if (stage == Measure0) {
+        image0 = image;
+        leak0 = leak;
+        report.irr_before_db = irr;
+        report.leakage_before_dbc = leakage;
+        stage = Settle1;
+        return false;
+    }
+    if (stage == Measure1) {
+        // First order: image and leakage move linearly with beta and dc
+        std::complex<double> image_gain = (image - image0) / probe_beta;
+        std::complex<double> leak_gain = (leak - leak0) / (probe_dc * double(amp));
+        if (std::abs(image_gain) < 1e-6 || std::abs(leak_gain) < 1e-12) {
+            stage = Idle;
+            return true;
+        }
+        base = IqCorrection::fromImage(base.beta() - image0 / image_gain, base.dc() - leak0 / leak_gain);
+        stage = Settle2;
+        return false;
+    }
+    report.irr_after_db = irr;
+    report.leakage_after_dbc = leakage;
+    report.ok = true;
+    stage = Idle;
+    return true;
+}
+
+void IqCalibrator::bins(const std::complex<float> *x, size_t n, std::complex<double> &p, std::complex<double> &neg,
+                        std::complex<double> &dc) const {
+    p = neg = dc = 0.0;
+    double w = 2.0 * M_PI * freq / fs;
+    std::complex<double> rot(1.0, 0.0), step(cos(w), -sin(w));
+    for (size_t i = 0; i < n; i++) {
+        double win = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+        std::complex<double> s = std::complex<double>(x[i]) * win;
+        p += s * rot;
+        neg += s * std::conj(rot);
+        dc += s;
+        rot *= step;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+
+// TX pre-correction for IQ imbalance and LO leakage: a 2x2 real matrix on
+// (I, Q) plus a DC offset. The calibrator below fills it in as
+// x + beta * conj(x) + dc, which cancels a modulator of the form
+// mu * x + nu * conj(x) + c when beta = -nu / mu and dc = -c / mu.
+struct IqCorrection {
+    float m11 = 1, m12 = 0, m21 = 0, m22 = 1;
+    float dc_i = 0, dc_q = 0;
+
+    static IqCorrection fromImage(std::complex<double> beta, std::complex<double> dc);
+
+    std::complex<double> beta() const { return {m11 - 1.0, m12}; }
+    std::complex<double> dc() const { return {dc_i, dc_q}; }
+};
+
+// In place on interleaved I/Q; four multiply-adds per sample, vectorized
+inline void applyIqCorrection(const IqCorrection &c, std::complex<float> *x, size_t n) {
+    float *f = reinterpret_cast<float *>(x);
+    for (size_t i = 0; i < n; i++) {
+        float re = f[2 * i], im = f[2 * i + 1];
+        f[2 * i] = c.m11 * re + c.m12 * im + c.dc_i;
+        f[2 * i + 1] = c.m21 * re + c.m22 * im + c.dc_q;
+    }
+}
+
+// Estimates an IqCorrection from a loopback capture of a test tone at +f.
+// Image (-f) and leakage (0 Hz) are measured relative to the tone with a
+// Hann-windowed DFT. The loop phase is unknown in hardware, so each
+// parameter is measured twice, the second time with a known probe added,
+// and the difference calibrates the loop. The tone phase cancels out of
+// image * tone / |tone|^2, and the leakage bin doesn't depend on it.
+class IqCalibrator {
+public:
+    struct Report {
+        bool ok;
+        double irr_before_db, irr_after_db;         // Image rejection (tone / image)
+        double leakage_before_dbc, leakage_after_dbc;
+    };
+
+    void start(const IqCorrection &current, double tone_hz, double rate, float amplitude);
+
+    bool active() const { return stage != Idle; }
+    const Report &lastReport() const { return report; }
+    const IqCorrection &result() const { return base; }
+
+    // What the TX should apply while calibrating: the base or the probe
+    IqCorrection correction() const {
+        if (stage == Settle1 || stage == Measure1)
+            return IqCorrection::fromImage(base.beta() + probe_beta, base.dc() + probe_dc * double(amp));
+        return base;
+    }
+
+    // The next n samples of the test tone
+    void tone(std::complex<float> *out, size_t n);
+
+    // Feed every full RX frame; returns true once the calibration is done
+    bool measure(const std::complex<float> *rx, size_t n);
+
+private:
+    enum Stage { Idle, Settle0, Measure0, Settle1, Measure1, Settle2, Verify };
+
+    const std::complex<double> probe_beta{0.03, 0.03};
+    const std::complex<double> probe_dc{0.03, 0.03}; // Relative to the tone amplitude
+
+    IqCorrection base;
+    double freq = 0, fs = 1, tone_phase = 0;
+    float amp = 0.5f;
+    Stage stage = Idle;
+    size_t frames = 0;
+    std::complex<double> image_sum, leak_sum, image0, leak0;
+    double image_pow = 0, leak_pow = 0;
+    Report report{false, NAN, NAN, NAN, NAN};
+
+    void clearSums() {
+        image_sum = leak_sum = 0.0;
+        image_pow = leak_pow = 0.0;
+    }
+
+    void bins(const std::complex<float> *x, size_t n, std::complex<double> &p, std::complex<double> &neg,
+              std::complex<double> &dc) const;
+};
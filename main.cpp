@@ -18,100 +18,1484 @@
 #include <QTimer>
 #include <QMutex>
 #include <QKeyEvent>
+#include <QListWidget>
+#include <QSpinBox>
+#include <QScrollArea>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QSlider>
 
-#include <uhd/usrp/multi_usrp.hpp>
-#include <uhd/device.hpp>
-#include <uhd/stream.hpp>
+#include "radio_backend.h"
+#include "sample_buffers.h"
+#include "fft.h"
+#include "spectrum.h"
+#include "channelizer.h"
+#include "decimators.h"
+#include "fm_demodulator.h"
+#include "zoom_fft.h"
+#include "wav_writer.h"
+#include "file_io.h"
+#include "power_stats.h"
+#include "preamble.h"
+#include "capture_ring.h"
+#include "event_store.h"
+#include "block_pool.h"
+#include "relay_processor.h"
+#include "waveform_library.h"
+#include "memory_budget.h"
+#include "analysis_scheduler.h"
+#include "frame_history.h"
+#include "dpd.h"
+#include "iq_correction.h"
+#include "sim_channel.h"
 #include <complex>
 #include <cmath>
 #include <atomic>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <numeric>
+#include <limits>
+#include <map>
+#include <filesystem>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sched.h>
+#include <dlfcn.h>
+#include <fcntl.h>
 
 using namespace QtCharts;
 
 // --- 1. THE WORKER (Handles Hardware & Math) ---
+
+// The UHD backend plugin is loaded on first use and stays loaded. It is
+// looked for next to the executable, then on the library path. A failed
+// load is retried on the next call, so installing the plugin or fixing the
+// library path does not need a restart.
+class BackendPlugin {
+public:
+    static CreateRadioBackendFn uhd(std::string &error) {
+        static std::mutex mutex;
+        static CreateRadioBackendFn create = nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        error.clear();
+        if (!create) {
+            const char *name = "libusrp_viz_uhd.so";
+            std::string local = QCoreApplication::applicationDirPath().toStdString() + "/" + name;
+            void *handle = dlopen(local.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (!handle) handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+            if (!handle) {
+                error = dlerror();
+            } else if (!(create = (CreateRadioBackendFn)dlsym(handle, RADIO_BACKEND_ENTRY))) {
+                error = dlerror();
+                dlclose(handle);
+            }
+        }
+        return create;
+    }
+};
+
+// Stands in for a device when tuning without hardware. TX drains in real
+// time from a buffer of num_send_frames * spp samples, so a profile
+// underflows here when this host's scheduling jitter outlasts what it
+// buffers, much as it would against a real transport. RX delivers silence.
+class SimTransportBackend : public RadioBackend {
+public:
+    std::vector<RadioDeviceInfo> findDevices() override { return {}; }
+
+    void open(const std::string &, const RadioConfig &config) override {
+        rate = config.rate;
+        restartStreams(config);
+    }
+
+    void close() override {}
+
+    void restartStreams(const RadioConfig &config) override {
+        capacity = double(config.tx_frames ? config.tx_frames : 32) * (config.tx_spp ? config.tx_spp : 2000);
+        level = 0.0;
+        playing = false;
+        underflow = false;
+    }
+
+    void setTxFreq(double) override {}
+    void setTxGain(double) override {}
+    void setRxGain(double) override {}
+    void rxGainRange(double &min_db, double &max_db) override {
+        min_db = 0.0;
+        max_db = 76.0;
+    }
+    double tuneRxAt(double, double lead_s) override { return lead_s; }
+    double setRxGainAt(double, double lead_s) override { return lead_s; }
+
+    size_t send(const std::complex<float> *, size_t n, double timeout_s) override {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_s);
+        drain();
+        while (level + n > capacity) {
+            if (std::chrono::steady_clock::now() >= deadline) return 0;
+            std::this_thread::sleep_for(std::chrono::duration<double>((level + n - capacity) / rate));
+            drain();
+        }
+        level += n;
+        playing = true;
+        return n;
+    }
+
+    size_t recv(std::complex<float> *samples, size_t n, double, bool &has_time, double &) override {
+        std::this_thread::sleep_for(std::chrono::duration<double>(n / rate));
+        std::fill(samples, samples + n, std::complex<float>(0.0f));
+        has_time = false;
+        return n;
+    }
+
+    bool takeTxUnderflow() override {
+        drain();
+        bool u = underflow;
+        underflow = false;
+        return u;
+    }
+
+    bool takeRxOverflow() override { return false; }
+
+    double endTxBurst(double) override {
+        auto t0 = std::chrono::steady_clock::now();
+        drain();
+        if (level > 0) std::this_thread::sleep_for(std::chrono::duration<double>(level / rate));
+        level = 0.0;
+        playing = false;
+        underflow = false; // Running dry at the end of a burst is expected
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+private:
+    double rate = 1e6;
+    double capacity = 0, level = 0; // Samples
+    bool playing = false, underflow = false;
+    std::chrono::steady_clock::time_point last;
+
+    // Plays out what has been due since the last call
+    void drain() {
+        auto now = std::chrono::steady_clock::now();
+        if (playing) {
+            double played = std::chrono::duration<double>(now - last).count() * rate;
+            if (played > level) underflow = true;
+            level = std::max(0.0, level - played);
+            if (level == 0.0) playing = false;
+        }
+        last = now;
+    }
+};
+
+// TX transport settings for one device, as picked by TransportTuner
+struct TransportProfile {
+    size_t block = 0;      // Samples per send() call; 0 means untuned
+    size_t spp = 0;        // 0 for the transport default
+    size_t frames = 0;
+    size_t buff_bytes = 0; // 0 for the transport default
+    // What the tuner measured with it
+    double cpu = 0;        // Fraction of one core spent sending
+    double latency_ms = 0; // Worst case queued ahead of a new sample
+    bool latency_measured = false; // Else latency_ms is the size of the queue
+    uint64_t underflows = 0;
+
+    bool valid() const { return block != 0; }
+};
+
+// Sweeps send block size, samples per packet, send frames and socket buffer
+// against an open device at the target rate, with RX off. Each candidate
+// streams a tone for a short trial while underflows and the sending thread's
+// CPU time are counted. The trial then ends the burst and times how long the
+// device takes to play out what was queued, which with the queue full is the
+// wait a new sample sees behind it; one send block is added for the sample
+// being generated. The winner is the lowest-latency profile that never underflowed
+// and kept the sender under half a core. Runs on its own thread; the device
+// must not be in use elsewhere meanwhile.
+class TransportTuner {
+public:
+    ~TransportTuner() {
+        cancel = true;
+        if (thread.joinable()) thread.join();
+    }
+
+    bool running() const { return busy; }
+    size_t trialsDone() const { return done; }
+    size_t trialCount() const { return candidates().size(); }
+
+    void start(std::unique_ptr<RadioBackend> backend, const std::string &args, const RadioConfig &config) {
+        if (thread.joinable()) thread.join();
+        radio = std::move(backend);
+        done = 0;
+        cancel = false;
+        busy = true;
+        thread = std::thread(&TransportTuner::sweep, this, args, config);
+    }
+
+    // True once per finished run; 'error' is empty on success
+    bool takeResult(TransportProfile &profile, std::string &error) {
+        if (busy || !finished) return false;
+        thread.join();
+        finished = false;
+        profile = best;
+        error = failure;
+        return true;
+    }
+
+private:
+    std::unique_ptr<RadioBackend> radio;
+    std::thread thread;
+    std::atomic<bool> busy{false}, cancel{false};
+    std::atomic<size_t> done{0};
+    bool finished = false; // Written before 'busy' is cleared
+    TransportProfile best;
+    std::string failure;
+
+    static std::vector<TransportProfile> candidates() {
+        std::vector<TransportProfile> out;
+        for (size_t block : {256, 512, 1024, 2048})
+            for (size_t frames : {4, 8, 16, 32})
+                for (size_t buff : {0, 1 << 20}) {
+                    TransportProfile p;
+                    p.block = block;
+                    p.spp = block < 2048 ? block : 0; // One packet per send, or the default
+                    p.frames = frames;
+                    p.buff_bytes = buff;
+                    out.push_back(p);
+                }
+        return out;
+    }
+
+    static double threadCpuSeconds() {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    void sweep(std::string args, RadioConfig config) {
+        const double warmup_s = 0.1, trial_s = 0.5;
+        std::vector<TransportProfile> results;
+        failure.clear();
+        config.rx = false; // Nobody reads it, so it would only overflow and load the bus
+        try {
+            std::vector<std::complex<float>> tone(2048);
+            for (size_t i = 0; i < tone.size(); i++) tone[i] = std::polar(0.3f, float(2 * M_PI * 0.01 * i));
+            bool opened = false;
+            for (TransportProfile p : candidates()) {
+                if (cancel) break;
+                config.tx_spp = p.spp;
+                config.tx_frames = p.frames;
+                config.tx_buff_bytes = p.buff_bytes;
+                if (!opened) radio->open(args, config);
+                else radio->restartStreams(config);
+                opened = true;
+
+                auto t0 = std::chrono::steady_clock::now();
+                double cpu0 = 0, elapsed = 0;
+                bool measuring = false;
+                while (elapsed < warmup_s + trial_s && !cancel) {
+                    for (size_t sent = 0; sent < p.block && !cancel;) sent += radio->send(tone.data() + sent, p.block - sent, 0.1);
+                    bool underflow = radio->takeTxUnderflow();
+                    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                    if (!measuring && elapsed >= warmup_s) {
+                        measuring = true;
+                        cpu0 = threadCpuSeconds();
+                    } else if (measuring && underflow) {
+                        p.underflows++;
+                    }
+                }
+                p.cpu = (threadCpuSeconds() - cpu0) / trial_s;
+                double drain_s = cancel ? -1.0 : radio->endTxBurst(1.0);
+                if (radio->takeTxUnderflow()) p.underflows++;
+                p.latency_measured = drain_s >= 0;
+                if (p.latency_measured) {
+                    p.latency_ms = (drain_s + p.block / config.rate) * 1e3;
+                } else {
+                    size_t packet = p.spp ? p.spp : p.block;
+                    p.latency_ms = (p.block + p.frames * packet) / config.rate * 1e3;
+                }
+                results.push_back(p);
+                done++;
+            }
+            if (opened) radio->close();
+        } catch (const std::exception &e) {
+            failure = e.what();
+        } catch (...) {
+            failure = "device error";
+        }
+        radio.reset();
+
+        // Clean and cheap first, then the least latency; with no clean
+        // profile, the fewest underflows
+        auto better = [](const TransportProfile &a, const TransportProfile &b) {
+            bool a_ok = a.underflows == 0 && a.cpu < 0.5, b_ok = b.underflows == 0 && b.cpu < 0.5;
+            if (a_ok != b_ok) return a_ok;
+            if (a.underflows != b.underflows) return a.underflows < b.underflows;
+            if (a.latency_ms != b.latency_ms) return a.latency_ms < b.latency_ms;
+            return a.cpu < b.cpu;
+        };
+        best = TransportProfile();
+        if (!results.empty()) best = *std::min_element(results.begin(), results.end(), better);
+        else if (failure.empty()) failure = "cancelled";
+        finished = true;
+        busy = false;
+    }
+};
+
 class RadioWorker : public QThread {
 public:
     std::atomic<bool> running{true};
     std::atomic<bool> hardware_connected{false};
+
+    // Recent RX frames and spectra for PAUSE VIEW to freeze. The depth is
+    // applied on connect; the frame pool grows by as many blocks.
+    std::atomic<double> freeze_seconds{2.0};
+    std::atomic<bool> freeze_capped{false}; // The memory limit cut the depth short
+    FrameHistory history;
+
+    // Views the GUI is drawing right now. Work that only feeds a view (its
+    // analysis task and the copy into shared_*) is skipped while nobody
+    // looks; detection, logging, capture and audio never depend on this.
+    enum Consumer : unsigned {
+        ScopeView = 1 << 0,
+        SpectrumView = 1 << 1, // Spectrum trace and mask limits
+        ZoomView = 1 << 2,
+        PanoramaView = 1 << 3,
+    };
+    std::atomic<unsigned> consumers{~0u};
+    bool wants(Consumer c) const { return consumers.load(std::memory_order_relaxed) & c; }
     
     // Settings
     std::atomic<double> frequency{915e6};
     std::atomic<double> gain{40.0};
+    std::atomic<double> rx_gain{30.0};
     std::atomic<double> amplitude{1.0};
-    std::atomic<int> waveform_type{0}; // 0=Sine, 1=Square
+    std::atomic<int> waveform_type{0}; // 0=Sine, 1=Square, 2=FM Test Tone, 3=Preamble Bursts, 4=Two-Tone
+
+    // Low-latency TX: small send blocks and few UHD send frames bound the
+    // samples queued ahead of a control change. Applied on connect.
+    std::atomic<bool> low_latency{false};
+    static constexpr size_t low_latency_block = 256;
+    static constexpr size_t low_latency_frames = 4;
+    // Tuned transport for the device being connected; when valid it replaces
+    // both the defaults and the low-latency settings. Set before start().
+    TransportProfile transport;
+
+    // Control-to-TX latency: the GUI stamps every TX parameter change and the
+    // worker measures until the first block generated with it has been sent.
+    // The stamp doubles as the change's identity, so one load sees a
+    // consistent edit; a newer edit simply replaces an older one.
+    std::atomic<int64_t> control_time_ns{0};
+    std::atomic<double> control_latency_ms{0.0};
+    std::atomic<double> control_latency_max_ms{0.0};
+    std::atomic<double> inflight_bound_ms{0.0}; // Samples that can sit ahead of a change
+
+    // RX -> TX relay: replaces the generator loop when chosen before connecting
+    std::atomic<bool> relay_mode{false};
+    std::atomic<double> relay_shift{0.0};   // Hz
+    std::atomic<double> relay_gain{0.0};    // dB
+    std::atomic<bool> relay_filter{false};
+    std::atomic<double> relay_cutoff{100e3}; // Hz
+    std::atomic<double> relay_latency_ms{0.0};
+    std::atomic<double> relay_jitter_ms{0.0};
+    std::atomic<double> relay_max_ms{0.0};
+    std::atomic<bool> relay_pinned{false};
+    std::atomic<uint64_t> relay_starved{0}; // Blocks skipped because the pool was empty
+
+    // Digital predistortion. Identification needs the RX to see the TX
+    // (loopback coupler); in simulation sim_pa adds a PA to distort.
+    std::atomic<bool> dpd_enabled{false};
+    std::atomic<bool> dpd_adapt{true}; // Keep refitting while enabled
+    std::atomic<bool> dpd_reset{false};
+    std::atomic<bool> sim_pa{false};
+    std::atomic<uint64_t> dpd_fits{0};
+    std::atomic<double> dpd_error_db{0.0}; // Loop error at the last fit, relative to the signal
+
+    // TX IQ imbalance / LO leakage pre-correction. A calibration plays a
+    // test tone, measures it on the RX and switches the correction on.
+    std::atomic<bool> iq_correct{false};
+    std::atomic<bool> iq_calibrate{false}; // Request from the GUI
+    std::atomic<bool> iq_calibrating{false};
+    std::atomic<bool> sim_iq_error{false};
+    std::atomic<double> iq_irr_before_db{NAN};
+    std::atomic<double> iq_irr_after_db{NAN};
+    std::atomic<double> iq_leak_before_dbc{NAN};
+    std::atomic<double> iq_leak_after_dbc{NAN};
+
+    // Pre-trigger capture. The ring is sized on connect; each trigger saves
+    // the samples around it as a SigMF recording in the working directory.
+    std::atomic<bool> capture_enabled{false};
+    std::atomic<double> capture_ring_s{10.0};
+    std::atomic<double> capture_pre_s{2.0};
+    std::atomic<double> capture_post_s{1.0};
+    std::atomic<bool> capture_on_detection{true};
+    std::atomic<bool> capture_on_preamble{true};
+    std::atomic<bool> capture_on_mask{false};
+    std::atomic<bool> capture_on_fault{true}; // TX underflow, RX overflow or timeout
+    std::atomic<bool> capture_now{false};     // Manual trigger from the GUI
+    std::atomic<bool> capture_active{false};  // A ring exists this session
+    std::atomic<uint64_t> capture_triggers{0};
+    std::atomic<uint64_t> capture_recordings{0};
+    std::atomic<uint64_t> capture_overruns{0};
+    std::atomic<bool> capture_writing{false};
+    QString capture_last_file; // Guarded by data_mutex
+
+    // Rendered waveforms survive reconnects, so switching back is instant
+    WaveformLibrary waveforms{64u << 20};
+
+    // Limit on the elastic memory of the running session (cache, history, ...)
+    MemoryBudget memory_budget{256u << 20};
+
+    // Live spectrum FFT size; sizes above one frame gather consecutive frames
+    std::atomic<int> spectrum_fft_size{2048};
+
+    // RX AGC. While enabled it owns the device gain; rx_gain is restored
+    // when it is turned off. Status is for the GUI.
+    std::atomic<bool> agc_enabled{false};
+    std::atomic<double> agc_target_dbfs{-20.0};
+    std::atomic<double> rx_gain_now{30.0};       // Gain at the newest RX sample
+    std::atomic<double> agc_level_dbfs{-120.0};  // Smoothed block power
+    std::atomic<uint64_t> rx_gain_steps{0};      // Gain changes tagged in the stream
+
+    // Energy detector settings & status
+    std::atomic<bool> detector_enabled{false};
+    std::atomic<double> detect_threshold{10.0}; // dB above noise floor
+    std::atomic<float> noise_floor_db{-120.0f};
+
+    // Spectrum mask settings & status. The GUI bumps mask_seq after changing
+    // the mask, which also restarts the statistics.
+    std::atomic<bool> mask_enabled{false};
+    std::atomic<bool> mask_save{false}; // Log violating frames to mask_violations.csv
+    std::atomic<uint64_t> mask_seq{0};
+    std::atomic<bool> mask_invalid{false};
+    std::atomic<uint64_t> mask_frames{0};
+    std::atomic<uint64_t> mask_failed{0}; // Frames with at least one bin over
+    std::atomic<uint64_t> mask_violations{0}; // Bins over, summed over all frames
+    std::atomic<double> mask_worst_db{INFINITY};
+    std::atomic<double> mask_first_fail_s{-1.0};
+    QString mask_spec = "0:0, 20:0, 40:-30, 100:-50, 300:-60"; // Guarded by data_mutex
+    bool mask_relative = true; // dBc when true, dBFS otherwise. Guarded by data_mutex
+
+    // Zoom FFT settings & status. The GUI bumps zoom_seq after a change.
+    std::atomic<bool> zoom_enabled{false};
+    std::atomic<double> zoom_center{0.0}; // Offset from the RX center, Hz
+    std::atomic<double> zoom_span{1e3};
+    std::atomic<int> zoom_fft_size{4096};
+    std::atomic<uint64_t> zoom_seq{0};
+    std::atomic<double> zoom_rbw{0.0}; // Hz per bin
+    std::atomic<double> zoom_load{0.0}; // Fraction of one core
+    std::atomic<uint64_t> zoom_spectra{0};
+
+    // Panorama scan settings & status
+    std::atomic<bool> panorama_enabled{false};
+    std::atomic<double> pano_start{900e6};
+    std::atomic<double> pano_stop{930e6};
+    std::atomic<double> pano_sec_per_ghz{0.0};
+
+    // Channelizer settings
+    std::atomic<bool> channelizer_enabled{false};
+    std::atomic<int> channel_count{16};
+    std::atomic<int> channel_oversample{1};
+    std::atomic<int> scope_source{0}; // 0=TX Waveform, 1=RX Stream, 2=Channelizer Output
+    std::atomic<int> scope_channel{0};
+    std::atomic<bool> channel_record{false};     // Record every channel while the channelizer runs
+    std::atomic<bool> channel_recording{false};  // Files are open
+    std::atomic<double> channel_record_seconds{0.0};
+    std::atomic<bool> channel_record_failed{false};
+
+    // FM demodulator settings & status
+    std::atomic<bool> fm_enabled{false};
+    std::atomic<int> fm_mode{0}; // FmDemodulator::Mode
+    std::atomic<double> fm_offset{10e3}; // Channel offset from RX center
+    std::atomic<double> fm_load{0.0}; // Fraction of one core spent demodulating
+    std::atomic<double> fm_seconds{0.0}; // Audio written so far
+    QString fm_target = "fm_audio.wav"; // Guarded by data_mutex
+
+    // Preamble correlator settings & status
+    std::atomic<bool> correlator_enabled{false};
+    std::atomic<double> correlator_threshold{0.5};
+    std::atomic<bool> scope_trigger{false}; // Freeze the RX scope on each detection
+    QString preamble_file = ""; // Raw fc32 reference; empty means ZC-127. Guarded by data_mutex
+
+    // Analysis scheduler status
+    std::atomic<size_t> analysis_threads{0};
+    std::atomic<uint64_t> analysis_starved{0}; // Frames not analyzed because every block was out
+    std::atomic<double> stream_epoch_s{0.0}; // Unix time of stream time 0, for the event database
 
     QMutex data_mutex;
     std::vector<std::complex<float>> shared_buffer;
+    SpectrumRef shared_spectrum; // RX power spectrum (dBFS), -fs/2..fs/2
+    std::vector<float> shared_mask; // Mask limits (dBFS) for the latest checked frame
+    std::vector<float> shared_zoom; // Latest zoom spectrum (dBFS), centered on zoom_center
+    double zoom_span_hz = 0; // Span of shared_zoom
+    std::vector<float> shared_panorama; // Last stitched sweep (dBFS)
+    double panorama_start_hz = 0, panorama_stop_hz = 0;
+    BlockRef relay_view; // Latest relayed block, shared with the GUI instead of copied
+    std::vector<AnalysisScheduler::TaskStats> shared_task_stats;
     QString device_args = "";
 
+    // Detections waiting for the GUI (which logs them to disk)
+    QMutex event_mutex;
+    std::vector<DetectionEvent> pending_events;
+    std::vector<DetectionEvent> parked_events; // Detector task only, see queueEvents()
+    std::atomic<uint64_t> dropped_events{0};
+    static constexpr size_t max_pending_events = 4096;
+    std::vector<PreambleDetection> pending_preambles;
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Called from the GUI whenever a setting that shapes the TX signal changes
+    void noteControlChange() {
+        // Strictly increasing, so two edits within one clock tick still differ
+        int64_t now = nowNs(), prev = control_time_ns.load();
+        while (!control_time_ns.compare_exchange_weak(prev, std::max(now, prev + 1))) {}
+    }
+
     void run() override {
-        uhd::usrp::multi_usrp::sptr usrp;
-        uhd::tx_streamer::sptr tx_stream;
-        uhd::tx_metadata_t md;
+        std::unique_ptr<RadioBackend> radio;
+        const bool fast = low_latency.load();
+        const TransportProfile profile = transport;
+        const size_t tx_block = profile.valid() ? profile.block : fast ? low_latency_block : 2048;
+        const double send_timeout = fast ? 0.005 : 0.1;
+        size_t send_frames = 0;
 
         // --- CONNECTION ATTEMPT ---
         try {
-            if (!device_args.isEmpty()) {
-                usrp = uhd::usrp::multi_usrp::make(uhd::device_addr_t(device_args.toStdString()));
-                usrp->set_tx_rate(1e6);
-                usrp->set_tx_freq(frequency.load());
-                usrp->set_tx_gain(gain.load());
-                
-                uhd::stream_args_t stream_args("fc32");
-                tx_stream = usrp->get_tx_stream(stream_args);
-                
-                md.start_of_burst = true;
-                md.end_of_burst = false;
+            std::string error;
+            CreateRadioBackendFn create = device_args.isEmpty() ? nullptr : BackendPlugin::uhd(error);
+            if (create) {
+                RadioConfig config{1e6, frequency.load(), gain.load(), rx_gain.load()};
+                if (profile.valid()) {
+                    config.tx_spp = profile.spp;
+                    config.tx_frames = profile.frames;
+                    config.tx_buff_bytes = profile.buff_bytes;
+                    send_frames = profile.frames;
+                } else if (fast) {
+                    config.tx_spp = tx_block;
+                    config.tx_frames = low_latency_frames;
+                    send_frames = low_latency_frames;
+                }
+                radio.reset(create());
+                radio->open(device_args.toStdString(), config);
                 hardware_connected = true;
             }
         } catch (...) {
+            radio.reset();
             hardware_connected = false;
         }
 
         // --- SIGNAL GENERATION LOOP ---
         const size_t buff_size = 2048; // Larger buffer for better zooming
         std::vector<std::complex<float>> buff(buff_size);
-        double phase = 0.0;
+        std::vector<std::complex<float>> rx_buff(buff_size);
         double current_freq = 10e3; 
         double sample_rate = 1e6;
 
-        while (running) {
-            double increment = 2.0 * M_PI * current_freq / sample_rate;
-            double amp = amplitude.load();
-            int type = waveform_type.load();
+        // Worst case ahead of a new setting: a change made just as the loop
+        // went into recv() waits out that frame, then the piece being
+        // generated, then every send frame UHD may still be holding. Without
+        // low-latency mode or a tuned profile the frame count is the
+        // transport default, so there is no bound.
+        size_t packet = profile.valid() && profile.spp ? profile.spp : tx_block;
+        inflight_bound_ms = send_frames ? (buff_size + tx_block + send_frames * packet) / sample_rate * 1e3 : -1.0;
+        int64_t applied_stamp = control_time_ns.load();
+        double applied_freq = frequency.load();
+        double applied_gain = gain.load();
+        double applied_rx_gain = rx_gain.load();
+        double latency_avg = 0.0, latency_max = 0.0;
+
+        SimChannel channel;
+        uint64_t rx_sample_count = 0;
+
+        // Panorama state: RX is retuned segment by segment with timed
+        // commands, and frames that start before the LO has settled are dropped.
+        const double tune_lead = 0.002;  // s between issuing and applying a tune
+        const double settle_time = 0.001;
+        PanoramaStitcher stitcher;
+        bool pano_running = false;
+        bool pano_stitching = false; // The current sweep is being stitched
+        size_t pano_segment = 0;
+        double rx_center = frequency.load();
+        double settle_until = 0.0;
+        std::vector<float> sweep;
+        double sweep_seconds = 0.0;
+
+        // RX gain changes are timed like retunes, so the first sample each
+        // applies to is known. It is found from the stream index and device
+        // time of the latest frame, and tagged on the frame that holds it.
+        // Until the device has timestamped a frame there is nothing to map a
+        // command time to, so changes before then apply at once.
+        RxAgc agc;
+        if (hardware_connected) radio->rxGainRange(agc.min_gain_db, agc.max_gain_db);
+        bool agc_was_enabled = false;
+        uint64_t clock_index = 0;
+        double clock_time = 0.0;
+        bool clock_valid = false; // clock_time is device time
+        bool gain_pending = false;
+        uint64_t gain_pending_index = 0;
+        double stream_gain = applied_rx_gain; // Gain at the next sample to arrive
+        rx_gain_now = stream_gain;
+        rx_gain_steps = 0;
+
+        // The generator and the correlator share one preamble. The correlator
+        // task replaces it; the generator notices through preamble_id.
+        std::mutex preamble_mutex;
+        std::shared_ptr<const std::vector<std::complex<float>>> preamble =
+            std::make_shared<const std::vector<std::complex<float>>>(zadoffChu(127, 25));
+        std::atomic<uint64_t> preamble_id{0};
+        WaveformRef playing;
+        WaveformKey playing_key{};
+        size_t play_pos = 0;
+
+        // Predistortion: fits run on the trainer's thread, and the TX path
+        // picks up each new model at the next block boundary
+        Predistorter predistorter;
+        DpdTrainer dpd_trainer(3, 3);
+        const size_t dpd_record = 4 * buff_size; // TX history searched for each capture
+        RecentSamples dpd_clean(dpd_record), dpd_sent(dpd_record);
+        size_t dpd_frames = 0;
+
+        // IQ pre-correction is the last stage before the radio
+        IqCorrection iq_correction;
+        IqCalibrator iq_cal;
+
+        // Received frames are handed to the analysis tasks in pooled blocks,
+        // so every task reads the same samples without a copy. The history
+        // holds on to its own share of blocks. The pool is allocated up front,
+        // so the history is capped to keep it within half the memory limit.
+        const size_t pool_cap = memory_budget.limit() / 2 / (buff_size * sizeof(std::complex<float>));
+        const size_t wanted_frames = size_t(freeze_seconds.load() * sample_rate / buff_size);
+        const size_t history_frames = std::min(wanted_frames, pool_cap > 128 ? pool_cap - 128 : 0);
+        freeze_capped = history_frames < wanted_frames;
+        history.setDepth(history_frames);
+        BlockPool frame_pool(buff_size, 128 + history_frames);
+
+        // Analysis state. Each piece belongs to exactly one task, and a task
+        // never runs on two threads at once.
+        SpectrumAnalyzer analyzer;
+        analyzer.configure(buff_size);
+        FftGatherer spec_gather;
+
+        SpectrumAnalyzer detect_analyzer;
+        detect_analyzer.configure(buff_size);
+        FftGatherer detect_gather;
+        EnergyDetector detector;
+        std::vector<float> detect_psd;
+        std::vector<DetectionEvent> events;
+
+        SpectrumAnalyzer mask_analyzer;
+        mask_analyzer.configure(buff_size);
+        SpectrumMask mask;
+        std::vector<float> mask_psd;
+        std::vector<float> mask_display;
+        uint64_t mask_applied_seq = 0;
+        bool mask_ready = false;
+        std::ofstream mask_log;
+        size_t mask_saved = 0;
+        const size_t max_saved_frames = 10000;
+
+        ZoomFft zoom;
+        std::vector<float> zoom_psd;
+        uint64_t zoom_applied_seq = 0;
+        uint64_t zoom_next = 0; // First sample index of the frame expected next
+        bool zoom_ready = false;
+
+        PolyphaseChannelizer channelizer;
+        ChannelRecorder channel_recorder;
+        std::vector<std::vector<std::complex<float>>> channel_out;
+
+        FmDemodulator fm;
+        WavWriter wav;
+        std::vector<float> audio;
+        PlanarSamples fm_split; // The frame split for the planar front end, only while demodulating
+
+        PreambleCorrelator correlator;
+        bool correlator_ready = false;
+        std::vector<PreambleDetection> preambles;
+        RecentSamples rx_history;
+        bool trigger_armed = false;
+        uint64_t trigger_index = 0;
+        std::vector<std::complex<float>> triggered_view;
+
+        // Every received sample goes through it, so ring indices are stream indices
+        std::unique_ptr<CaptureRing> capture;
+        auto captureTrigger = [&](uint64_t index, const char *reason, double lo_hz = 0, double hi_hz = 0) {
+            if (capture && capture_enabled) capture->trigger(index, reason, lo_hz, hi_hz);
+        };
+
+        // Declared after the state its tasks use, so its threads are joined first
+        AnalysisScheduler scheduler;
+
+        // Spectrum view and freeze history: late frames are worthless, the
+        // display wants the newest one
+        int spectrum_task = scheduler.addTask("spectrum", 3, 50.0, [&](const AnalysisFrame &f) {
+            size_t fft_size = spectrum_fft_size.load();
+            if (analyzer.size() != fft_size) analyzer.configure(fft_size);
+            const AnalysisFrame *meta;
+            bool settled;
+            const std::complex<float> *x = spec_gather.add(f, fft_size, meta, settled);
+            if (!x) return;
+            // Each spectrum is its own shared object, so the view and the
+            // history take references instead of copies
+            auto spectrum = std::make_shared<SpectrumFrame>();
+            spectrum->first_index = meta->first_index;
+            spectrum->time_s = meta->time_s;
+            spectrum->center_hz = meta->center_hz;
+            analyzer.process(x, spectrum->psd_db);
+            history.push(SpectrumRef(spectrum));
+            if (wants(SpectrumView) && data_mutex.tryLock()) {
+                shared_spectrum = std::move(spectrum);
+                data_mutex.unlock();
+            }
+        });
+
+        // Detection has to see every frame, and a dropped frame would restart
+        // the gathering for FFTs over one frame, so like the mask it has its
+        // own FFT and no deadline
+        int detector_task = scheduler.addTask("detector", 3, 0.0, [&](const AnalysisFrame &f) {
+            size_t fft_size = spectrum_fft_size.load();
+            if (detect_analyzer.size() != fft_size) detect_analyzer.configure(fft_size);
+            const AnalysisFrame *meta;
+            bool settled;
+            const std::complex<float> *x = detect_gather.add(f, fft_size, meta, settled);
+            if (!x || !settled) return;
+            detect_analyzer.process(x, detect_psd);
+            detector.threshold_db = detect_threshold.load();
+            events.clear();
+            noise_floor_db = detector.process(detect_psd, meta->center_hz, sample_rate, meta->time_s, events);
+            for (auto &ev : events) ev.rx_gain_db = meta->rx_gain_db;
+            queueEvents(events);
+            if (capture_on_detection) {
+                for (const auto &ev : events) captureTrigger(meta->first_index, "energy", ev.start_hz, ev.stop_hz);
+            }
+        });
+
+        // Compliance is judged on every frame, so the mask task has its own
+        // FFT and no deadline
+        int mask_task = scheduler.addTask("mask", 3, 0.0, [&](const AnalysisFrame &f) {
+            if (!mask_ready || mask_seq.load() != mask_applied_seq) {
+                mask_applied_seq = mask_seq.load();
+                data_mutex.lock();
+                std::string spec = mask_spec.toStdString();
+                bool relative = mask_relative;
+                data_mutex.unlock();
+                std::vector<MaskPoint> points;
+                if (!SpectrumMask::parse(spec, points)) {
+                    mask_invalid = true;
+                    mask_enabled = false;
+                    mask_ready = false;
+                    return;
+                }
+                mask.configure(points, relative, buff_size, sample_rate);
+                mask_invalid = false;
+                mask_ready = true;
+                mask_frames = 0;
+                mask_failed = 0;
+                mask_violations = 0;
+                mask_worst_db = INFINITY;
+                mask_first_fail_s = -1.0;
+            }
+
+            mask_analyzer.process(f.block->data, mask_psd);
+            SpectrumMask::Result r = mask.check(mask_psd.data(), mask_psd.size());
+            mask_frames++;
+            if (r.worst_margin_db < mask_worst_db.load()) mask_worst_db = r.worst_margin_db;
+            if (r.violations > 0) {
+                if (capture_on_mask) captureTrigger(f.first_index, "mask");
+                if (mask_failed++ == 0) mask_first_fail_s = f.time_s;
+                mask_violations += r.violations;
+                if (mask_save && mask_saved < max_saved_frames) {
+                    if (!mask_log.is_open()) {
+                        openCsvLog(mask_log, "mask_violations.csv", "time_s,center_hz,violations,worst_margin_db,psd_dbfs...");
+                    }
+                    mask_log << f.time_s << "," << f.center_hz << "," << r.violations << "," << r.worst_margin_db;
+                    for (float v : mask_psd) mask_log << "," << v;
+                    mask_log << "\n";
+                    mask_saved++;
+                }
+            }
+
+            if (wants(SpectrumView) && data_mutex.tryLock()) {
+                mask_display.resize(mask.bins());
+                for (size_t k = 0; k < mask.bins(); k++) mask_display[k] = mask.limits()[k] + r.reference_db;
+                shared_mask.swap(mask_display);
+                data_mutex.unlock();
+            }
+        });
+
+        // The zoom FFT needs a gapless stream, so it has no deadline either;
+        // after a gap (the view was hidden, or the pool ran dry) it starts over
+        int zoom_task = scheduler.addTask("zoom", 1, 0.0, [&](const AnalysisFrame &f) {
+            if (f.first_index != zoom_next) zoom_ready = false;
+            zoom_next = f.first_index + f.block->size;
+            if (!zoom_ready || zoom_seq.load() != zoom_applied_seq) {
+                zoom_applied_seq = zoom_seq.load();
+                zoom.configure(sample_rate, zoom_center.load(), zoom_span.load(), zoom_fft_size.load(), 4);
+                zoom_rbw = zoom.resolution();
+                zoom_spectra = 0;
+                zoom_ready = true;
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            bool ready = zoom.process(f.block->data, f.block->size, zoom_psd);
+            double busy = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            zoom_load = 0.95 * zoom_load.load() + 0.05 * busy / (f.block->size / sample_rate);
+            if (ready) {
+                zoom_spectra++;
+                data_mutex.lock();
+                shared_zoom = zoom_psd;
+                zoom_span_hz = zoom.outputRate();
+                data_mutex.unlock();
+            }
+        });
+
+        int channelizer_task = scheduler.addTask("channelizer", 2, 0.0, [&](const AnalysisFrame &f) {
+            size_t m = channel_count.load(), os = channel_oversample.load();
+            bool reconfigure = channelizer.channels() != m || channelizer.oversample() != os;
+            if (reconfigure) channelizer.configure(m, os);
+            for (auto &ch : channel_out) ch.clear();
+            channelizer.process(f.block->data, f.block->size, channel_out);
+
+            // A new channel layout starts a new set of files
+            bool record = channel_record && channelizer_enabled;
+            if (channel_recorder.isOpen() && (!record || reconfigure)) channel_recorder.close();
+            if (record && !channel_recorder.isOpen() && !channel_record_failed) {
+                channel_record_failed = !channel_recorder.open(".", m, os, sample_rate, f.center_hz);
+            }
+            channel_recorder.write(channel_out, f.center_hz);
+            channel_recording = channel_recorder.isOpen();
+            channel_record_seconds = channel_recorder.secondsWritten();
+
+            if (data_mutex.tryLock()) {
+                size_t k = scope_channel.load();
+                if (scope_source.load() == 2) {
+                    if (k < channel_out.size()) shared_buffer = channel_out[k];
+                    else shared_buffer.clear();
+                }
+                data_mutex.unlock();
+            }
+        });
+
+        // Audio must be continuous, so the demodulator has no deadline; it only
+        // misses frames the radio could not analyze at all. It sees every
+        // frame so that stopping it also closes the file.
+        int fm_task = scheduler.addTask("fm", 4, 0.0, [&](const AnalysisFrame &f) {
+            if (!fm_enabled) {
+                if (wav.isOpen()) wav.close();
+                return;
+            }
+            auto mode = FmDemodulator::Mode(fm_mode.load());
+            if (!wav.isOpen() || fm.currentMode() != mode || fm.currentOffset() != fm_offset.load()) {
+                fm.configure(mode, sample_rate, fm_offset.load());
+                if (!wav.isOpen()) {
+                    data_mutex.lock();
+                    std::string target = fm_target.toStdString();
+                    data_mutex.unlock();
+                    if (!wav.open(target, (uint32_t)fm.audioRate())) {
+                        fm_enabled = false;
+                        return;
+                    }
+                }
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            audio.clear();
+            fm_split.resize(f.block->size);
+            deinterleave(f.block->data, f.block->size, fm_split.i.data(), fm_split.q.data());
+            fm.process(fm_split.i.data(), fm_split.q.data(), f.block->size, audio);
+            wav.write(audio);
+            double busy = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            fm_load = 0.95 * fm_load.load() + 0.05 * busy / (f.block->size / sample_rate);
+            fm_seconds = wav.secondsWritten();
+        });
+
+        // Detections must not be missed, so the correlator has no deadline
+        // either. It also owns the RX history used by the scope trigger.
+        int correlator_task = scheduler.addTask("correlator", 2, 0.0, [&](const AnalysisFrame &f) {
+            const std::complex<float> *x = f.block->data;
+            size_t n = f.block->size;
+            if (correlator_enabled) {
+                if (!correlator_ready) {
+                    data_mutex.lock();
+                    std::string path = preamble_file.toStdString();
+                    data_mutex.unlock();
+                    std::vector<std::complex<float>> loaded;
+                    if (path.empty() || !loadFc32(path, loaded) || loaded.empty()) loaded = zadoffChu(127, 25);
+                    correlator.setReference(loaded, sample_rate);
+                    {
+                        std::lock_guard<std::mutex> lock(preamble_mutex);
+                        preamble = std::make_shared<const std::vector<std::complex<float>>>(std::move(loaded));
+                    }
+                    preamble_id++;
+                    correlator_ready = true;
+                }
+                correlator.threshold = correlator_threshold.load();
+                preambles.clear();
+                correlator.process(x, n, f.first_index, preambles);
+                for (auto &det : preambles) {
+                    det.time_s = f.time_s + ((double)det.sample_index - (double)f.first_index) / sample_rate;
+                    det.center_hz = f.center_hz;
+                    if (capture_on_preamble) captureTrigger(det.sample_index, "preamble");
+                    if (scope_trigger && !trigger_armed) {
+                        trigger_armed = true;
+                        trigger_index = det.sample_index;
+                    }
+                }
+                if (!preambles.empty() && event_mutex.tryLock()) {
+                    if (pending_preambles.size() < max_pending_events)
+                        pending_preambles.insert(pending_preambles.end(), preambles.begin(), preambles.end());
+                    event_mutex.unlock();
+                }
+            } else {
+                correlator_ready = false;
+            }
+
+            // The triggered window may reach into later frames, so wait for it
+            if (scope_trigger) rx_history.push(x, n);
+            if (trigger_armed && rx_history.end() >= trigger_index + buff_size) {
+                rx_history.copy(trigger_index, buff_size, triggered_view);
+                trigger_armed = false;
+                if (scope_source.load() == 1 && scope_trigger) {
+                    data_mutex.lock();
+                    shared_buffer = triggered_view;
+                    data_mutex.unlock();
+                }
+            }
+        });
+
+        // Scope feed: only the newest frame matters
+        int display_task = scheduler.addTask("display", 1, 33.0, [&](const AnalysisFrame &f) {
+            if (data_mutex.tryLock()) {
+                shared_buffer.assign(f.block->data, f.block->data + f.block->size);
+                data_mutex.unlock();
+            }
+        });
+
+        // Elastic memory, given back in this order when over the limit: the
+        // freeze history gets shorter (and longer again once there is room),
+        // then cached waveforms, which are cheap to re-render, are evicted.
+        // The RX history is a fixed, small ring, and the frame pool, panorama
+        // trace and capture ring are set by the settings, so they are only
+        // counted.
+        const size_t sample_bytes = sizeof(std::complex<float>);
+        auto freeze_reg = memory_budget.add("Freeze history", 0, [&] { return history.spectrumBytes(); },
+            [&](size_t excess) { return history.shrink(excess); },
+            [&](size_t headroom) { return history.grow(headroom); });
+        auto cache_reg = memory_budget.add("Waveform cache", 1,
+            [&] { return waveforms.stats().bytes; },
+            [&](size_t excess) {
+                size_t used = waveforms.stats().bytes;
+                return waveforms.trim(used > excess ? used - excess : 0);
+            });
+        auto history_reg = memory_budget.add("RX history", 2, [&] { return rx_history.capacity() * sample_bytes; });
+        auto pool_reg = memory_budget.add("Frame pool", 2, [&] { return (128 + history_frames) * buff_size * sample_bytes; });
+        auto pano_reg = memory_budget.add("Panorama", 2, [&] { return stitcher.bytes(); });
+
+        // The radio keeps the last core to itself; analysis gets the rest.
+        // The relay path pins itself and needs no analysis.
+        const bool relay = relay_mode.load();
+        if (!relay && capture_enabled) {
+            size_t frames = std::max<size_t>(2, size_t(capture_ring_s.load() * sample_rate / buff_size));
+            try {
+                capture.reset(new CaptureRing(frames * buff_size, buff_size, sample_rate, "."));
+            } catch (const std::bad_alloc &) {
+                capture_enabled = false;
+            }
+        }
+        capture_active = bool(capture);
+        if (capture) capture->tagGain(0, stream_gain);
+        // Sized once here; the probe keeps the number, not the pointer
+        auto capture_reg = memory_budget.add("Capture ring", 2, [bytes = capture ? capture->bytes() : 0] { return bytes; });
+        if (!relay) {
+            unsigned cores = std::thread::hardware_concurrency();
+            if (cores > 1) pinCurrentThread(cores - 1);
+            scheduler.start(1);
+        }
+        analysis_threads = scheduler.threadCount();
+        size_t frames_since_stats = 0;
+
+        auto tuneRx = [&](double center, double stream_time) {
+            rx_center = center;
+            double apply_at = stream_time;
+            if (hardware_connected) apply_at = radio->tuneRxAt(center, tune_lead);
+            settle_until = apply_at + settle_time;
+        };
+
+        auto changeRxGain = [&](double db, double stream_time) {
+            applied_rx_gain = db;
+            double apply_at = stream_time;
+            channel.rx_gain_db = db; // Simulation: from the next frame, which starts at stream_time
+            gain_pending = true;
+            if (hardware_connected && !clock_valid) {
+                radio->setRxGain(db);
+                gain_pending_index = rx_sample_count; // The next sample to arrive, as near as is known
+            } else {
+                if (hardware_connected) apply_at = radio->setRxGainAt(db, tune_lead);
+                gain_pending_index = clock_index + uint64_t(std::max(0.0, std::round((apply_at - clock_time) * sample_rate)));
+            }
+            settle_until = std::max(settle_until, apply_at + settle_time);
+        };
+
+        if (relay) relayLoop(radio.get(), sample_rate);
 
-            for (size_t i = 0; i < buff_size; i++) {
-                double val_i, val_q;
-                if (type == 0) { // SINE
-                    val_i = cos(phase);
-                    val_q = sin(phase);
-                } else { // SQUARE
-                    val_i = (cos(phase) > 0) ? 1.0 : -1.0;
-                    val_q = (sin(phase) > 0) ? 1.0 : -1.0;
+        while (running && !relay) {
+            bool agc_on = agc_enabled.load();
+            if (agc_on != agc_was_enabled) {
+                agc.reset(applied_rx_gain);
+                agc_was_enabled = agc_on;
+            }
+            if (!agc_on && !gain_pending && rx_gain.load() != applied_rx_gain) {
+                changeRxGain(rx_gain.load(), rx_sample_count / sample_rate);
+            }
+            if (iq_calibrate.exchange(false) && !iq_cal.active()) {
+                iq_cal.start(iq_correction, 50e3, sample_rate, 0.5f);
+                iq_calibrating = true;
+            }
+
+            // TX goes out in tx_block pieces; parameters are re-read for each,
+            // so a change waits at most one piece before it is generated
+            for (size_t offset = 0; offset < buff_size; offset += tx_block) {
+                int64_t stamp = control_time_ns.load();
+
+                // Settings that need a device call go out before the piece
+                // they apply to, so the latency below includes the call
+                if (frequency.load() != applied_freq) {
+                    applied_freq = frequency.load();
+                    if (hardware_connected) radio->setTxFreq(applied_freq);
+                    if (!pano_running) tuneRx(applied_freq, rx_sample_count / sample_rate);
+                }
+                if (hardware_connected && gain.load() != applied_gain) {
+                    applied_gain = gain.load();
+                    radio->setTxGain(applied_gain);
                 }
-                buff[i] = std::complex<float>(val_i * amp, val_q * amp);
-                phase += increment;
-                if (phase > 2 * M_PI) phase -= 2 * M_PI;
+
+                // Playback loops over a cached render; a new key switches at
+                // this block boundary, keeping the loop position so tones
+                // stay phase-continuous across amplitude changes
+                int type = waveform_type.load();
+                WaveformKey key{type, float(amplitude.load()), current_freq, sample_rate, type == 3 ? preamble_id.load() : 0};
+                if (!playing || !(key == playing_key)) {
+                    playing = waveforms.get(key, [&](const WaveformKey &k, Waveform &out) {
+                        std::shared_ptr<const std::vector<std::complex<float>>> ref;
+                        {
+                            std::lock_guard<std::mutex> lock(preamble_mutex);
+                            ref = preamble;
+                        }
+                        renderWaveform(k, *ref, out);
+                    });
+                    playing_key = key;
+                    play_pos %= playing->size();
+                }
+                for (size_t i = offset; i < offset + tx_block; i++) {
+                    buff[i] = (*playing)[play_pos];
+                    if (++play_pos == playing->size()) play_pos = 0;
+                }
+
+                if (iq_cal.active()) {
+                    // The test tone replaces the generator for the whole calibration
+                    iq_cal.tone(buff.data() + offset, tx_block);
+                    applyIqCorrection(iq_cal.correction(), buff.data() + offset, tx_block);
+                } else {
+                    if (dpd_enabled) {
+                        dpd_clean.push(buff.data() + offset, tx_block);
+                        predistorter.setModel(dpd_trainer.model());
+                        predistorter.process(buff.data() + offset, tx_block);
+                        dpd_sent.push(buff.data() + offset, tx_block);
+                    }
+                    if (iq_correct) applyIqCorrection(iq_correction, buff.data() + offset, tx_block);
+                }
+
+                if (hardware_connected) {
+                    // Short timeouts keep the loop responsive; whatever didn't
+                    // fit is retried rather than dropped
+                    size_t sent = 0;
+                    while (sent < tx_block && running) {
+                        sent += radio->send(buff.data() + offset + sent, tx_block - sent, send_timeout);
+                    }
+                } else {
+                    QThread::usleep(tx_block * 1e6 / sample_rate); // Sleep roughly equivalent to buffer time
+                }
+
+                if (stamp != applied_stamp) {
+                    applied_stamp = stamp;
+                    double ms = (nowNs() - stamp) / 1e6;
+                    latency_avg = (latency_avg == 0.0) ? ms : 0.8 * latency_avg + 0.2 * ms;
+                    latency_max = std::max(latency_max, ms);
+                    control_latency_ms = latency_avg;
+                    control_latency_max_ms = latency_max;
+                }
+            }
+
+            // --- RECEIVE PATH ---
+            double rx_time = rx_sample_count / sample_rate;
+            // A sweep retunes the receiver. Its frames feed detection, mask
+            // checks and capture like any other, so it only pauses when none
+            // of those runs and its view is not shown.
+            bool pano_wanted = panorama_enabled && (wants(PanoramaView) || detector_enabled || mask_enabled ||
+                                                    correlator_enabled || capture_enabled);
+            if (pano_wanted && !pano_running) {
+                stitcher.begin(pano_start.load(), pano_stop.load(), sample_rate, buff_size);
+                pano_segment = 0;
+                pano_running = true;
+                tuneRx(stitcher.segmentCenter(0), rx_time);
+                stitcher.startSweep();
+            } else if (!pano_wanted && pano_running) {
+                pano_running = false;
+                tuneRx(frequency.load(), rx_time);
             }
 
+            // Receive straight into a pooled block when one is free; otherwise
+            // the frame still keeps the stream and panorama going, unanalyzed
+            BlockRef blk = frame_pool.acquire();
+            if (!blk) analysis_starved++;
+            std::complex<float> *rx_dst = blk ? blk->data : rx_buff.data();
+            size_t num_rx = buff_size;
+            bool has_time = false;
             if (hardware_connected) {
-                tx_stream->send(buff.data(), buff.size(), md);
-                md.start_of_burst = false;
+                double stamp = 0.0;
+                num_rx = radio->recv(rx_dst, buff_size, 0.1, has_time, stamp);
+                if (has_time) rx_time = stamp;
             } else {
-                QThread::usleep(2000); // Sleep roughly equivalent to buffer time
+                channel.pa_enabled = sim_pa;
+                channel.iq_impaired = sim_iq_error;
+                channel.propagate(buff, frequency.load(), rx_center, sample_rate, rx_buff);
+                if (blk) std::copy(rx_buff.begin(), rx_buff.end(), rx_dst);
+            }
+            BlockPower rx_power = blockPower(rx_dst, num_rx);
+            uint64_t frame_index = rx_sample_count;
+            rx_sample_count += num_rx;
+            clock_index = frame_index;
+            clock_time = rx_time;
+            if (has_time) clock_valid = true;
+
+            // Tag the gain change that lands in this frame, if any
+            double frame_gain = stream_gain;
+            size_t gain_step_at = num_rx;
+            if (gain_pending && gain_pending_index < rx_sample_count) {
+                gain_step_at = size_t(std::max(gain_pending_index, frame_index) - frame_index);
+                if (gain_step_at == 0) frame_gain = applied_rx_gain;
+                stream_gain = applied_rx_gain;
+                gain_pending = false;
+                if (capture) capture->tagGain(frame_index + gain_step_at, stream_gain);
+                rx_gain_now = stream_gain;
+                rx_gain_steps++;
             }
 
+            // The AGC sits out sweeps and IQ calibration, which need a fixed
+            // gain, and only sees blocks taken wholly at the current gain
+            if (agc_enabled && !gain_pending && !pano_running && !iq_cal.active() && rx_time >= settle_until &&
+                num_rx == buff_size) {
+                agc.target_dbfs = agc_target_dbfs.load();
+                double next;
+                if (agc.update(rx_power, num_rx / sample_rate, next)) changeRxGain(next, rx_sample_count / sample_rate);
+                agc_level_dbfs = agc.level();
+            }
+            if (frame_index == 0) {
+                stream_epoch_s = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count() -
+                                 rx_time - num_rx / sample_rate;
+            }
+
+            if (capture) {
+                capture->setWindow(capture_pre_s.load(), capture_post_s.load());
+                capture->push(rx_dst, num_rx, rx_center);
+                if (capture_now.exchange(false)) captureTrigger(rx_sample_count, "manual");
+                if (hardware_connected && capture_on_fault) {
+                    if (radio->takeTxUnderflow()) captureTrigger(frame_index, "tx underflow");
+                    if (radio->takeRxOverflow()) captureTrigger(frame_index, "rx overflow");
+                    if (num_rx < buff_size) captureTrigger(rx_sample_count, "rx timeout");
+                }
+            }
+
+            // Every full frame goes to the analysis tasks; partial ones (timeouts) are skipped
+            if (num_rx == buff_size) {
+                if (blk) {
+                    blk->size = num_rx;
+                    auto frame = std::make_shared<AnalysisFrame>();
+                    frame->block = std::move(blk);
+                    frame->first_index = frame_index;
+                    frame->time_s = rx_time;
+                    frame->center_hz = rx_center;
+                    frame->settled = rx_time >= settle_until;
+                    frame->posted_ns = nowNs();
+                    frame->rx_gain_db = frame_gain;
+                    frame->gain_step_at = gain_step_at;
+                    frame->gain_step_db = stream_gain;
+                    // Tasks whose only output is a view are posted only while it is shown
+                    int source = scope_source.load();
+                    if (wants(SpectrumView)) scheduler.post(spectrum_task, frame);
+                    if (detector_enabled) scheduler.post(detector_task, frame);
+                    if (mask_enabled) scheduler.post(mask_task, frame);
+                    if (zoom_enabled && wants(ZoomView)) scheduler.post(zoom_task, frame);
+                    // Recording sees every frame, so it also notices being stopped
+                    if ((channelizer_enabled && ((source == 2 && wants(ScopeView)) || channel_record)) || channel_recording)
+                        scheduler.post(channelizer_task, frame);
+                    scheduler.post(fm_task, frame);
+                    scheduler.post(correlator_task, frame);
+                    if (source == 1 && !scope_trigger && wants(ScopeView)) scheduler.post(display_task, frame);
+                    history.push(FrameRef(frame));
+                }
+
+                if (iq_cal.active() && iq_cal.measure(rx_dst, num_rx)) {
+                    const IqCalibrator::Report &r = iq_cal.lastReport();
+                    iq_irr_before_db = r.irr_before_db;
+                    iq_leak_before_dbc = r.leakage_before_dbc;
+                    iq_irr_after_db = r.irr_after_db;
+                    iq_leak_after_dbc = r.leakage_after_dbc;
+                    if (r.ok) {
+                        iq_correction = iq_cal.result();
+                        iq_correct = true;
+                    }
+                    iq_calibrating = false;
+                }
+
+                // About ten captures a second go to the DPD trainer, each with
+                // the TX record it should fall inside
+                if (dpd_reset.exchange(false)) dpd_trainer.reset();
+                if (dpd_enabled && dpd_adapt && ++dpd_frames >= 50 && dpd_sent.end() >= dpd_record) {
+                    std::vector<std::complex<float>> clean, sent;
+                    dpd_clean.copy(dpd_clean.end() - dpd_record, dpd_record, clean);
+                    dpd_sent.copy(dpd_sent.end() - dpd_record, dpd_record, sent);
+                    if (dpd_trainer.submit(std::move(clean), std::move(sent),
+                                           std::vector<std::complex<float>>(rx_dst, rx_dst + num_rx))) dpd_frames = 0;
+                    DpdTrainer::Status st = dpd_trainer.lastStatus();
+                    dpd_fits = st.fits;
+                    dpd_error_db = st.error_db;
+                }
+
+                // Hand the settled segment off and immediately tune the next one
+                // Stitching only feeds the view, so a sweep is stitched only
+                // if the view was shown for all of it
+                if (pano_running && rx_time >= settle_until) {
+                    if (pano_segment == 0) pano_stitching = wants(PanoramaView);
+                    else if (!wants(PanoramaView)) pano_stitching = false;
+                    if (pano_stitching) stitcher.submit(pano_segment, rx_dst, num_rx);
+                    pano_segment = (pano_segment + 1) % stitcher.segmentCount();
+                    tuneRx(stitcher.segmentCenter(pano_segment), rx_time + buff_size / sample_rate);
+                    if (pano_segment == 0) stitcher.startSweep();
+                }
+            }
+
+            bool have_sweep = pano_running && stitcher.takeSweep(sweep, sweep_seconds);
+            if (have_sweep) {
+                double span = stitcher.traceStop() - stitcher.traceStart();
+                pano_sec_per_ghz = sweep_seconds / (span / 1e9);
+            }
+
+            // About four times a second at 1 MS/s
+            std::vector<AnalysisScheduler::TaskStats> task_stats;
+            if (++frames_since_stats >= 128) {
+                task_stats = scheduler.stats();
+                if (capture) {
+                    CaptureRing::Status cs = capture->status();
+                    capture_triggers = cs.triggers;
+                    capture_recordings = cs.recordings;
+                    capture_overruns = cs.overruns;
+                    capture_writing = cs.writing;
+                    if (!cs.last_file.empty() && data_mutex.tryLock()) {
+                        capture_last_file = QString::fromStdString(cs.last_file);
+                        data_mutex.unlock();
+                    }
+                }
+            }
+
+            // Analysis results are published by their tasks; what is left here
+            // is the TX scope, the panorama and clearing disabled outputs
             if (data_mutex.tryLock()) {
-                shared_buffer = buff;
+                int source = scope_source.load();
+                if (source == 0 && wants(ScopeView)) shared_buffer = buff;
+                else if (source == 2 && !channelizer_enabled) shared_buffer.clear();
+                if (!mask_enabled) shared_mask.clear();
+                if (have_sweep && wants(PanoramaView)) {
+                    shared_panorama.swap(sweep);
+                    panorama_start_hz = stitcher.traceStart();
+                    panorama_stop_hz = stitcher.traceStop();
+                }
+                if (!task_stats.empty()) {
+                    shared_task_stats.swap(task_stats);
+                    frames_since_stats = 0;
+                }
                 data_mutex.unlock();
             }
         }
         
-        if (hardware_connected) {
-            md.end_of_burst = true;
-            tx_stream->send("", 0, md);
+        iq_calibrating = false;
+        capture_active = false;
+        channel_recording = false;
+
+        if (hardware_connected) radio->close();
+    }
+
+    // One loop period of a generator waveform. Phases are computed from the
+    // sample index rather than accumulated, so the loop closes exactly.
+    static void renderWaveform(const WaveformKey &key, const std::vector<std::complex<float>> &preamble, Waveform &out) {
+        const size_t burst_period = 10000; // 10 ms at 1 MS/s
+        const double fm_tone = 1e3, fm_deviation = 5e3;
+        uint64_t rate = llround(key.sample_rate);
+        uint64_t tone = llround(key.tone_hz);
+        size_t len;
+        if (key.type == 3) len = std::max(burst_period, preamble.size());
+        else if (key.type == 2) len = rate / std::gcd(rate, std::gcd(tone, (uint64_t)fm_tone));
+        else len = rate / std::gcd(rate, tone);
+
+        out.resize(len);
+        float amp = key.amplitude;
+        for (size_t i = 0; i < len; i++) {
+            double phase = 2.0 * M_PI * key.tone_hz * i / key.sample_rate;
+            double val_i, val_q;
+            if (key.type == 0) { // SINE
+                val_i = cos(phase);
+                val_q = sin(phase);
+            } else if (key.type == 1) { // SQUARE
+                val_i = (cos(phase) > 0) ? 1.0 : -1.0;
+                val_q = (sin(phase) > 0) ? 1.0 : -1.0;
+            } else if (key.type == 4) { // TWO-TONE (+/- tone_hz, envelope swings 0..amp)
+                val_i = cos(phase);
+                val_q = 0.0;
+            } else if (key.type == 3) { // PREAMBLE BURSTS (one preamble per period)
+                std::complex<float> s = i < preamble.size() ? preamble[i] : 0.0f;
+                val_i = s.real();
+                val_q = s.imag();
+            } else { // FM TEST TONE (1 kHz at 5 kHz deviation)
+                phase -= (fm_deviation / fm_tone) * cos(2.0 * M_PI * fm_tone * i / key.sample_rate);
+                val_i = cos(phase);
+                val_q = sin(phase);
+            }
+            out[i] = std::complex<float>(val_i * amp, val_q * amp);
         }
     }
+
+    // --- RX -> TX RELAY ---
+    // Received blocks go through RelayProcessor and straight back to send().
+    // Blocks come from a pool, the thread is pinned, and nothing else runs on
+    // this path. In simulation the generator's tone plays the far-end
+    // transmitter and the simulated channel delivers it.
+    void relayLoop(RadioBackend *radio, double sample_rate) {
+        const size_t block = 256;
+        const size_t stats_window = 512;
+        BlockPool pool(block, 16);
+        RelayProcessor dsp;
+        double cfg_shift = NAN, cfg_gain = NAN, cfg_cutoff = NAN;
+        bool cfg_filter = false;
+
+        unsigned cores = std::thread::hardware_concurrency();
+        relay_pinned = pinCurrentThread(cores > 0 ? cores - 1 : 0);
+
+        SimChannel channel;
+        std::vector<std::complex<float>> far_end(block), received;
+        double far_phase = 0.0;
+
+        double sum = 0, sum_sq = 0, worst = 0;
+        size_t count = 0;
+
+        while (running) {
+            if (relay_shift.load() != cfg_shift || relay_gain.load() != cfg_gain ||
+                relay_filter.load() != cfg_filter || relay_cutoff.load() != cfg_cutoff) {
+                cfg_shift = relay_shift.load();
+                cfg_gain = relay_gain.load();
+                cfg_filter = relay_filter.load();
+                cfg_cutoff = relay_cutoff.load();
+                dsp.configure(sample_rate, cfg_shift, cfg_gain, cfg_filter, cfg_cutoff);
+            }
+
+            BlockRef blk = pool.acquire();
+            if (!blk) {
+                relay_starved++;
+                QThread::usleep(block * 1e6 / sample_rate);
+                continue;
+            }
+
+            int64_t arrived;
+            if (hardware_connected) {
+                bool has_time;
+                double stamp;
+                blk->size = radio->recv(blk->data, block, 0.1, has_time, stamp);
+                arrived = nowNs();
+                if (blk->size == 0) continue;
+            } else {
+                double increment = 2.0 * M_PI * 10e3 / sample_rate;
+                for (auto &s : far_end) {
+                    s = std::complex<float>(cos(far_phase), sin(far_phase)) * float(amplitude.load());
+                    far_phase = fmod(far_phase + increment, 2 * M_PI);
+                }
+                QThread::usleep(block * 1e6 / sample_rate);
+                arrived = nowNs();
+                channel.propagate(far_end, frequency.load(), frequency.load(), sample_rate, received);
+                std::copy(received.begin(), received.end(), blk->data);
+                blk->size = block;
+            }
+
+            dsp.process(blk->data, blk->size);
+
+            if (hardware_connected) {
+                size_t sent = 0;
+                while (sent < blk->size && running) {
+                    sent += radio->send(blk->data + sent, blk->size - sent, 0.005);
+                }
+            }
+
+            // recv() returns once the last sample is in, so the first one
+            // arrived a block earlier
+            double ms = (nowNs() - arrived) / 1e6 + blk->size / sample_rate * 1e3;
+            sum += ms;
+            sum_sq += ms * ms;
+            worst = std::max(worst, ms);
+            if (++count == stats_window) {
+                double mean = sum / count;
+                relay_latency_ms = mean;
+                relay_jitter_ms = std::sqrt(std::max(0.0, sum_sq / count - mean * mean));
+                relay_max_ms = worst;
+                sum = sum_sq = worst = 0;
+                count = 0;
+            }
+
+            if (data_mutex.tryLock()) {
+                relay_view = blk;
+                data_mutex.unlock();
+            }
+        }
+
+        data_mutex.lock();
+        relay_view.reset();
+        data_mutex.unlock();
+        history.setDepth(0);
+    }
+
+    // Hands detections to the GUI without ever waiting for it. Detector
+    // task only: while the GUI holds the lock they are parked and go in with
+    // the next frame's, so only a full queue drops any.
+    void queueEvents(const std::vector<DetectionEvent> &events) {
+        for (const auto &ev : events) {
+            if (parked_events.size() < max_pending_events) parked_events.push_back(ev);
+            else dropped_events++;
+        }
+        if (parked_events.empty() || !event_mutex.tryLock()) return;
+        for (const auto &ev : parked_events) {
+            if (pending_events.size() < max_pending_events) pending_events.push_back(ev);
+            else dropped_events++;
+        }
+        event_mutex.unlock();
+        parked_events.clear();
+    }
 };
 
 // --- 2. CUSTOM CHART VIEW (For better Zoom handling) ---
@@ -130,23 +1514,156 @@ public:
 };
 
 // --- 3. THE MAIN GUI WINDOW ---
+
+// Milliseconds since the kernel started this process, so shared-library
+// loading before main() counts too. Resolution is one clock tick.
+static double msSinceProcessStart() {
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    std::getline(stat, line);
+    size_t comm_end = line.rfind(')');
+    if (comm_end == std::string::npos) return -1;
+    std::istringstream fields(line.substr(comm_end + 2));
+    std::string field;
+    for (int i = 3; i <= 22; i++) fields >> field; // Field 22 is starttime
+    timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    double start_s = std::stod(field) / sysconf(_SC_CLK_TCK);
+    return (now.tv_sec + now.tv_nsec / 1e9 - start_s) * 1e3;
+}
+
 class MainWindow : public QMainWindow {
     RadioWorker *worker;
     QChart *chart;
     QLineSeries *seriesI; 
     QLineSeries *seriesQ;
+    QChart *specChart;
+    ZoomableChartView *specView;
+    QLineSeries *specSeries;
+    std::vector<float> specBins; // Latest full-resolution spectrum, re-reduced on zoom
+    std::vector<float> reducedPos, reducedVal;
+    QLineSeries *thresholdSeries;
+    QLineSeries *maskSeries;
+    QChart *panoChart;
+    QLineSeries *panoSeries;
+    ZoomableChartView *panoView;
     QTimer *timer;
     bool isPaused = false;
+    static constexpr int scope_points = 500; // Scope samples drawn per frame
+    FrameHistory::Snapshot frozen; // What the paused view scrubs through
+    SpectrumAnalyzer frozen_analyzer; // Spectra the history didn't keep
+    double startup_ms = -1; // Process start to the first drawn frame
+    bool exit_after_startup = false;
+    std::ofstream eventLog;
+    EventStore eventStore; // Every detection and preamble, across sessions
+    QElapsedTimer eventSyncTimer;
+    std::vector<StoredEvent> searchHits;
+    TransportTuner tuner;
+    QString tuneArgs; // Device the tuner is running against
     
     // UI Elements
     QComboBox *deviceCombo;
     QLabel *statusLabel;
+    QPushButton *tuneBtn;
+    QLabel *transportLabel;
     QDoubleSpinBox *freqBox;
     QDoubleSpinBox *gainBox;
     QDoubleSpinBox *ampBox;
     QComboBox *waveCombo;
+    QCheckBox *lowLatencyCheck;
+    QSpinBox *cacheBudgetBox;
+    QLabel *cacheLabel;
+    QLabel *latencyLabel;
+    QCheckBox *relayCheck;
+    QDoubleSpinBox *relayShiftBox;
+    QDoubleSpinBox *relayGainBox;
+    QCheckBox *relayFilterCheck;
+    QDoubleSpinBox *relayCutoffBox;
+    QLabel *relayLabel;
+    QCheckBox *dpdCheck;
+    QCheckBox *dpdAdaptCheck;
+    QCheckBox *simPaCheck;
+    QPushButton *dpdResetBtn;
+    QLabel *dpdLabel;
+    QCheckBox *iqCorrectCheck;
+    QCheckBox *simIqCheck;
+    QPushButton *iqCalBtn;
+    QLabel *iqLabel;
     QPushButton *connectBtn;
     QPushButton *pauseBtn;
+    QSpinBox *freezeDepthBox;
+    QSlider *freezeSlider;
+    QLabel *freezeLabel;
+    QDoubleSpinBox *rxGainBox;
+    QCheckBox *agcCheck;
+    QDoubleSpinBox *agcTargetBox;
+    QLabel *agcLabel;
+    QPushButton *detectBtn;
+    QDoubleSpinBox *thresholdBox;
+    QLabel *floorLabel;
+    QListWidget *eventList;
+    QDoubleSpinBox *dbFromBox;
+    QDoubleSpinBox *dbToBox;
+    QDoubleSpinBox *dbLoBox;
+    QDoubleSpinBox *dbHiBox;
+    QComboBox *dbKindCombo;
+    QPushButton *dbSearchBtn;
+    QListWidget *dbResultList;
+    QLabel *dbLabel;
+    QLineEdit *maskEdit;
+    QComboBox *maskUnitCombo;
+    QCheckBox *maskSaveCheck;
+    QPushButton *maskBtn;
+    QLabel *maskLabel;
+    QLabel *memoryLabel;
+    QLabel *tasksLabel;
+    QLabel *startupLabel;
+    QSpinBox *memLimitBox;
+    QLabel *budgetLabel;
+    QDoubleSpinBox *panoStartBox;
+    QDoubleSpinBox *panoStopBox;
+    QPushButton *panoBtn;
+    QLabel *panoLabel;
+    QDoubleSpinBox *zoomCenterBox;
+    QDoubleSpinBox *zoomSpanBox;
+    QComboBox *zoomSizeCombo;
+    QPushButton *zoomFromViewBtn;
+    QPushButton *zoomFrozenBtn;
+    QPushButton *zoomBtn;
+    QLabel *zoomLabel;
+    QChart *zoomChart;
+    QLineSeries *zoomSeries;
+    ZoomableChartView *zoomView;
+    QPushButton *chanBtn;
+    QComboBox *chanCountCombo;
+    QComboBox *chanOsCombo;
+    QSpinBox *chanSelectBox;
+    QCheckBox *chanRecordCheck;
+    QLabel *chanRecordLabel;
+    QComboBox *scopeCombo;
+    QComboBox *specFftCombo;
+    QComboBox *specReduceCombo;
+    QComboBox *fmModeCombo;
+    QDoubleSpinBox *fmOffsetBox;
+    QLineEdit *fmTargetEdit;
+    QPushButton *fmBtn;
+    QLabel *fmLabel;
+    QLineEdit *refFileEdit;
+    QDoubleSpinBox *corrThreshBox;
+    QCheckBox *triggerCheck;
+    QPushButton *corrBtn;
+    QLabel *corrLabel;
+    QCheckBox *captureCheck;
+    QDoubleSpinBox *captureRingBox;
+    QDoubleSpinBox *capturePreBox;
+    QDoubleSpinBox *capturePostBox;
+    QCheckBox *captureDetCheck;
+    QCheckBox *capturePreambleCheck;
+    QCheckBox *captureMaskCheck;
+    QCheckBox *captureFaultCheck;
+    QPushButton *captureNowBtn;
+    QLabel *captureLabel;
+    uint64_t preambleCount = 0;
 
 public:
     MainWindow() {
@@ -167,7 +1684,15 @@ public:
         QGroupBox *devGroup = new QGroupBox("Device");
         QVBoxLayout *devLayout = new QVBoxLayout(devGroup);
         deviceCombo = new QComboBox();
-        refreshDevices();
+        deviceCombo->addItem("Simulation Mode");
+
+        // libuhd is only loaded from here, so simulation starts without it
+        QPushButton *scanBtn = new QPushButton("SCAN FOR HARDWARE");
+
+        // Sweeps the TX transport against the selected device while stopped
+        tuneBtn = new QPushButton("AUTO-TUNE TRANSPORT");
+        transportLabel = new QLabel("Transport: defaults (not tuned)");
+        transportLabel->setWordWrap(true);
         
         connectBtn = new QPushButton("INITIALIZE SYSTEM");
         connectBtn->setCheckable(true);
@@ -180,6 +1705,9 @@ public:
 
         devLayout->addWidget(new QLabel("Select Hardware Interface:"));
         devLayout->addWidget(deviceCombo);
+        devLayout->addWidget(scanBtn);
+        devLayout->addWidget(tuneBtn);
+        devLayout->addWidget(transportLabel);
         devLayout->addWidget(connectBtn);
         devLayout->addWidget(statusLabel);
         panelLayout->addWidget(devGroup);
@@ -206,13 +1734,414 @@ public:
         waveCombo = new QComboBox();
         waveCombo->addItem("Sine Wave");
         waveCombo->addItem("Square Wave");
+        waveCombo->addItem("FM Test Tone");
+        waveCombo->addItem("Preamble Bursts");
+        waveCombo->addItem("Two-Tone");
 
         sigLayout->addRow("Center Freq:", freqBox);
         sigLayout->addRow("TX Gain:", gainBox);
         sigLayout->addRow("Amplitude:", ampBox);
         sigLayout->addRow("Modulation:", waveCombo);
+
+        cacheBudgetBox = new QSpinBox();
+        cacheBudgetBox->setRange(1, 4096);
+        cacheBudgetBox->setValue(64);
+        cacheBudgetBox->setSuffix(" MB");
+        cacheLabel = new QLabel("Cache: empty");
+        cacheLabel->setWordWrap(true);
+        sigLayout->addRow("Wave Cache:", cacheBudgetBox);
+        sigLayout->addRow(cacheLabel);
+
+        lowLatencyCheck = new QCheckBox("Low-Latency TX (on connect)");
+        latencyLabel = new QLabel("Control->TX: --");
+        latencyLabel->setWordWrap(true);
+        sigLayout->addRow(lowLatencyCheck);
+        sigLayout->addRow(latencyLabel);
         panelLayout->addWidget(sigGroup);
 
+        // Receiver / Energy Detector Group
+        QGroupBox *rxGroup = new QGroupBox("Energy Detector");
+        QFormLayout *rxLayout = new QFormLayout(rxGroup);
+
+        rxGainBox = new QDoubleSpinBox();
+        rxGainBox->setRange(0, 76);
+        rxGainBox->setValue(30);
+        rxGainBox->setSuffix(" dB");
+
+        agcCheck = new QCheckBox("AGC (timed gain steps)");
+        agcCheck->setToolTip("Holds the RX level at the target; RX Gain applies again when it is off");
+        agcTargetBox = new QDoubleSpinBox();
+        agcTargetBox->setRange(-60, -3);
+        agcTargetBox->setValue(-20);
+        agcTargetBox->setSuffix(" dBFS");
+        agcLabel = new QLabel("AGC: off");
+        agcLabel->setWordWrap(true);
+
+        thresholdBox = new QDoubleSpinBox();
+        thresholdBox->setRange(1, 60);
+        thresholdBox->setValue(10);
+        thresholdBox->setSuffix(" dB");
+
+        detectBtn = new QPushButton("ENABLE DETECTOR");
+        detectBtn->setCheckable(true);
+
+        floorLabel = new QLabel("Noise Floor: --");
+
+        eventList = new QListWidget();
+        eventList->setMaximumHeight(120);
+
+        rxLayout->addRow("RX Gain:", rxGainBox);
+        rxLayout->addRow(agcCheck);
+        rxLayout->addRow("AGC Target:", agcTargetBox);
+        rxLayout->addRow(agcLabel);
+        rxLayout->addRow("Threshold:", thresholdBox);
+        rxLayout->addRow(detectBtn);
+        rxLayout->addRow(floorLabel);
+        rxLayout->addRow(eventList);
+        panelLayout->addWidget(rxGroup);
+
+        // Spectrum Mask Group
+        QGroupBox *maskGroup = new QGroupBox("Spectrum Mask");
+        QFormLayout *maskLayout = new QFormLayout(maskGroup);
+
+        maskEdit = new QLineEdit("0:0, 20:0, 40:-30, 100:-50, 300:-60");
+        maskEdit->setToolTip("offset_kHz:limit_dB pairs, increasing offset; offsets >= 0 apply to both sides");
+
+        maskUnitCombo = new QComboBox();
+        maskUnitCombo->addItem("dBc (to peak)");
+        maskUnitCombo->addItem("dBFS");
+
+        maskSaveCheck = new QCheckBox("Save failing frames");
+
+        maskBtn = new QPushButton("START MASK TEST");
+        maskBtn->setCheckable(true);
+
+        maskLabel = new QLabel("Mask: idle");
+        maskLabel->setWordWrap(true);
+
+        maskLayout->addRow("Mask:", maskEdit);
+        maskLayout->addRow("Limits:", maskUnitCombo);
+        maskLayout->addRow(maskSaveCheck);
+        maskLayout->addRow(maskBtn);
+        maskLayout->addRow(maskLabel);
+        panelLayout->addWidget(maskGroup);
+
+        // Panorama Scan Group
+        QGroupBox *panoGroup = new QGroupBox("Panorama Scan");
+        QFormLayout *panoLayout = new QFormLayout(panoGroup);
+
+        panoStartBox = new QDoubleSpinBox();
+        panoStartBox->setRange(70, 6000);
+        panoStartBox->setValue(900);
+        panoStartBox->setSuffix(" MHz");
+
+        panoStopBox = new QDoubleSpinBox();
+        panoStopBox->setRange(70, 6000);
+        panoStopBox->setValue(930);
+        panoStopBox->setSuffix(" MHz");
+
+        panoBtn = new QPushButton("START PANORAMA");
+        panoBtn->setCheckable(true);
+
+        panoLabel = new QLabel("Sweep: --");
+
+        panoLayout->addRow("Start:", panoStartBox);
+        panoLayout->addRow("Stop:", panoStopBox);
+        panoLayout->addRow(panoBtn);
+        panoLayout->addRow(panoLabel);
+        panelLayout->addWidget(panoGroup);
+
+        // Zoom FFT Group
+        QGroupBox *zoomGroup = new QGroupBox("Zoom FFT");
+        QFormLayout *zoomLayout = new QFormLayout(zoomGroup);
+
+        zoomCenterBox = new QDoubleSpinBox();
+        zoomCenterBox->setRange(-500, 500);
+        zoomCenterBox->setDecimals(3);
+        zoomCenterBox->setValue(10);
+        zoomCenterBox->setSuffix(" kHz");
+
+        zoomSpanBox = new QDoubleSpinBox();
+        zoomSpanBox->setRange(250, 250000);
+        zoomSpanBox->setValue(1000);
+        zoomSpanBox->setSuffix(" Hz");
+
+        zoomSizeCombo = new QComboBox();
+        for (int n : {1024, 4096, 16384, 65536}) zoomSizeCombo->addItem(QString::number(n), n);
+        zoomSizeCombo->setCurrentIndex(1);
+
+        zoomFromViewBtn = new QPushButton("USE SPECTRUM VIEW");
+        zoomFromViewBtn->setToolTip("Zoom into the spectrum plot first (drag a box), then take its span here");
+
+        zoomBtn = new QPushButton("START ZOOM");
+        zoomBtn->setCheckable(true);
+
+        zoomFrozenBtn = new QPushButton("ZOOM FROZEN");
+        zoomFrozenBtn->setToolTip("Runs the zoom over the paused history, up to the slider position");
+        zoomFrozenBtn->setEnabled(false);
+
+        zoomLabel = new QLabel("RBW: --");
+        zoomLabel->setWordWrap(true);
+
+        zoomLayout->addRow("Center:", zoomCenterBox);
+        zoomLayout->addRow("Span:", zoomSpanBox);
+        zoomLayout->addRow("FFT Size:", zoomSizeCombo);
+        zoomLayout->addRow(zoomFromViewBtn);
+        zoomLayout->addRow(zoomBtn);
+        zoomLayout->addRow(zoomFrozenBtn);
+        zoomLayout->addRow(zoomLabel);
+        panelLayout->addWidget(zoomGroup);
+
+        // Channelizer Group
+        QGroupBox *chanGroup = new QGroupBox("Channelizer");
+        QFormLayout *chanLayout = new QFormLayout(chanGroup);
+
+        chanCountCombo = new QComboBox();
+        for (int m : {8, 16, 32, 64, 128, 256}) chanCountCombo->addItem(QString::number(m), m);
+        chanCountCombo->setCurrentIndex(1);
+
+        chanOsCombo = new QComboBox();
+        chanOsCombo->addItem("Critically Sampled", 1);
+        chanOsCombo->addItem("2x Oversampled", 2);
+
+        chanSelectBox = new QSpinBox();
+        chanSelectBox->setRange(0, 15);
+
+        chanRecordCheck = new QCheckBox("Record All Channels (SigMF)");
+        chanRecordCheck->setToolTip("One channels_<time>_chNNN.sigmf-data/-meta pair per channel, in the working directory");
+        chanRecordLabel = new QLabel("Recording: off");
+
+        chanBtn = new QPushButton("ENABLE CHANNELIZER");
+        chanBtn->setCheckable(true);
+
+        chanLayout->addRow("Channels:", chanCountCombo);
+        chanLayout->addRow("Output Rate:", chanOsCombo);
+        chanLayout->addRow("Scope Channel:", chanSelectBox);
+        chanLayout->addRow(chanRecordCheck);
+        chanLayout->addRow(chanRecordLabel);
+        chanLayout->addRow(chanBtn);
+        panelLayout->addWidget(chanGroup);
+
+        // FM Demodulator Group
+        QGroupBox *fmGroup = new QGroupBox("FM Demodulator");
+        QFormLayout *fmLayout = new QFormLayout(fmGroup);
+
+        fmModeCombo = new QComboBox();
+        fmModeCombo->addItem("Broadcast FM");
+        fmModeCombo->addItem("Narrowband FM");
+
+        fmOffsetBox = new QDoubleSpinBox();
+        fmOffsetBox->setRange(-450, 450);
+        fmOffsetBox->setValue(10);
+        fmOffsetBox->setSuffix(" kHz");
+
+        fmTargetEdit = new QLineEdit("fm_audio.wav");
+        fmTargetEdit->setToolTip("WAV file, '-' for stdout, or '|command' to pipe");
+
+        fmBtn = new QPushButton("START DEMOD");
+        fmBtn->setCheckable(true);
+
+        fmLabel = new QLabel("Audio: --");
+
+        fmLayout->addRow("Mode:", fmModeCombo);
+        fmLayout->addRow("Offset:", fmOffsetBox);
+        fmLayout->addRow("Output:", fmTargetEdit);
+        fmLayout->addRow(fmBtn);
+        fmLayout->addRow(fmLabel);
+        panelLayout->addWidget(fmGroup);
+
+        // Preamble Correlator Group
+        QGroupBox *corrGroup = new QGroupBox("Preamble Correlator");
+        QFormLayout *corrLayout = new QFormLayout(corrGroup);
+
+        refFileEdit = new QLineEdit();
+        refFileEdit->setPlaceholderText("ZC-127 (built in)");
+        refFileEdit->setToolTip("Raw fc32 reference waveform");
+
+        corrThreshBox = new QDoubleSpinBox();
+        corrThreshBox->setRange(0.05, 1.0);
+        corrThreshBox->setSingleStep(0.05);
+        corrThreshBox->setValue(0.5);
+
+        triggerCheck = new QCheckBox("Trigger RX scope");
+
+        corrBtn = new QPushButton("START CORRELATOR");
+        corrBtn->setCheckable(true);
+
+        corrLabel = new QLabel("Detections: 0");
+        corrLabel->setWordWrap(true);
+
+        corrLayout->addRow("Reference:", refFileEdit);
+        corrLayout->addRow("Threshold:", corrThreshBox);
+        corrLayout->addRow(triggerCheck);
+        corrLayout->addRow(corrBtn);
+        corrLayout->addRow(corrLabel);
+        panelLayout->addWidget(corrGroup);
+
+        // Event Database Group
+        QGroupBox *dbGroup = new QGroupBox("Event Database");
+        QFormLayout *dbLayout = new QFormLayout(dbGroup);
+
+        dbFromBox = new QDoubleSpinBox();
+        dbFromBox->setRange(0, 100000);
+        dbFromBox->setDecimals(2);
+        dbFromBox->setSuffix(" h");
+        dbFromBox->setToolTip("Hours since the first stored event");
+        dbToBox = new QDoubleSpinBox();
+        dbToBox->setRange(0, 100000);
+        dbToBox->setDecimals(2);
+        dbToBox->setValue(100000);
+        dbToBox->setSuffix(" h");
+
+        dbLoBox = new QDoubleSpinBox();
+        dbLoBox->setRange(0, 6000);
+        dbLoBox->setDecimals(3);
+        dbLoBox->setValue(0);
+        dbLoBox->setSuffix(" MHz");
+        dbHiBox = new QDoubleSpinBox();
+        dbHiBox->setRange(0, 6000);
+        dbHiBox->setDecimals(3);
+        dbHiBox->setValue(6000);
+        dbHiBox->setSuffix(" MHz");
+
+        dbKindCombo = new QComboBox();
+        dbKindCombo->addItem("All Events");
+        dbKindCombo->addItem("Energy Detections");
+        dbKindCombo->addItem("Preambles");
+
+        dbSearchBtn = new QPushButton("SEARCH");
+
+        dbResultList = new QListWidget();
+        dbResultList->setMaximumHeight(120);
+        dbResultList->setToolTip("Double-click a hit to find it in the spectrum and the capture recordings");
+
+        dbLabel = new QLabel("Stored: --");
+        dbLabel->setWordWrap(true);
+
+        dbLayout->addRow("From:", dbFromBox);
+        dbLayout->addRow("To:", dbToBox);
+        dbLayout->addRow("Low:", dbLoBox);
+        dbLayout->addRow("High:", dbHiBox);
+        dbLayout->addRow("Kind:", dbKindCombo);
+        dbLayout->addRow(dbSearchBtn);
+        dbLayout->addRow(dbResultList);
+        dbLayout->addRow(dbLabel);
+        panelLayout->addWidget(dbGroup);
+
+        // Pre-Trigger Capture Group
+        QGroupBox *captureGroup = new QGroupBox("Pre-Trigger Capture");
+        QFormLayout *captureLayout = new QFormLayout(captureGroup);
+
+        captureCheck = new QCheckBox("Capture Ring (on connect)");
+
+        captureRingBox = new QDoubleSpinBox();
+        captureRingBox->setRange(1, 120);
+        captureRingBox->setValue(10);
+        captureRingBox->setSuffix(" s");
+        captureRingBox->setToolTip("RAM ring at full rate, 8 MB per second at 1 MS/s");
+
+        capturePreBox = new QDoubleSpinBox();
+        capturePreBox->setRange(0, 120);
+        capturePreBox->setValue(2);
+        capturePreBox->setSuffix(" s");
+
+        capturePostBox = new QDoubleSpinBox();
+        capturePostBox->setRange(0, 600);
+        capturePostBox->setValue(1);
+        capturePostBox->setSuffix(" s");
+
+        captureDetCheck = new QCheckBox("Detections");
+        captureDetCheck->setChecked(true);
+        capturePreambleCheck = new QCheckBox("Preambles");
+        capturePreambleCheck->setChecked(true);
+        captureMaskCheck = new QCheckBox("Mask Failures");
+        captureFaultCheck = new QCheckBox("Stream Faults");
+        captureFaultCheck->setChecked(true);
+        captureFaultCheck->setToolTip("TX underflow, RX overflow or RX timeout");
+
+        captureNowBtn = new QPushButton("CAPTURE NOW (F9)");
+
+        captureLabel = new QLabel("Recordings: --");
+        captureLabel->setWordWrap(true);
+
+        captureLayout->addRow(captureCheck);
+        captureLayout->addRow("Ring:", captureRingBox);
+        captureLayout->addRow("Pre-Trigger:", capturePreBox);
+        captureLayout->addRow("Post-Trigger:", capturePostBox);
+        captureLayout->addRow(captureDetCheck, capturePreambleCheck);
+        captureLayout->addRow(captureMaskCheck, captureFaultCheck);
+        captureLayout->addRow(captureNowBtn);
+        captureLayout->addRow(captureLabel);
+        panelLayout->addWidget(captureGroup);
+
+        // Relay Group
+        QGroupBox *relayGroup = new QGroupBox("RX -> TX Relay");
+        QFormLayout *relayLayout = new QFormLayout(relayGroup);
+
+        relayCheck = new QCheckBox("Relay Mode (on connect)");
+
+        relayShiftBox = new QDoubleSpinBox();
+        relayShiftBox->setRange(-400, 400);
+        relayShiftBox->setSuffix(" kHz");
+
+        relayGainBox = new QDoubleSpinBox();
+        relayGainBox->setRange(-40, 20);
+        relayGainBox->setSuffix(" dB");
+
+        relayFilterCheck = new QCheckBox("Lowpass");
+        relayCutoffBox = new QDoubleSpinBox();
+        relayCutoffBox->setRange(5, 450);
+        relayCutoffBox->setValue(100);
+        relayCutoffBox->setSuffix(" kHz");
+
+        relayLabel = new QLabel("Latency: --");
+        relayLabel->setWordWrap(true);
+
+        relayLayout->addRow(relayCheck);
+        relayLayout->addRow("Shift:", relayShiftBox);
+        relayLayout->addRow("Gain:", relayGainBox);
+        relayLayout->addRow(relayFilterCheck, relayCutoffBox);
+        relayLayout->addRow(relayLabel);
+        panelLayout->addWidget(relayGroup);
+
+        // Predistortion Group
+        QGroupBox *dpdGroup = new QGroupBox("Predistortion");
+        QFormLayout *dpdLayout = new QFormLayout(dpdGroup);
+
+        dpdCheck = new QCheckBox("Enable DPD");
+        dpdCheck->setToolTip("Needs the RX to hear the TX, e.g. through a loopback coupler");
+        dpdAdaptCheck = new QCheckBox("Adapt");
+        dpdAdaptCheck->setChecked(true);
+        simPaCheck = new QCheckBox("Simulated PA (no hardware)");
+        dpdResetBtn = new QPushButton("RESET MODEL");
+
+        dpdLabel = new QLabel("Model: identity");
+        dpdLabel->setWordWrap(true);
+
+        dpdLayout->addRow(dpdCheck, dpdAdaptCheck);
+        dpdLayout->addRow(simPaCheck);
+        dpdLayout->addRow(dpdResetBtn);
+        dpdLayout->addRow(dpdLabel);
+        panelLayout->addWidget(dpdGroup);
+
+        // IQ Correction Group
+        QGroupBox *iqGroup = new QGroupBox("TX IQ Correction");
+        QFormLayout *iqLayout = new QFormLayout(iqGroup);
+
+        iqCorrectCheck = new QCheckBox("Apply correction");
+        simIqCheck = new QCheckBox("Simulated IQ error (no hardware)");
+        iqCalBtn = new QPushButton("CALIBRATE");
+        iqCalBtn->setToolTip("Plays a 50 kHz tone for about 0.1 s; the RX must hear the TX");
+
+        iqLabel = new QLabel("Image rejection: not measured");
+        iqLabel->setWordWrap(true);
+
+        iqLayout->addRow(iqCorrectCheck);
+        iqLayout->addRow(simIqCheck);
+        iqLayout->addRow(iqCalBtn);
+        iqLayout->addRow(iqLabel);
+        panelLayout->addWidget(iqGroup);
+
         // View Control Group
         QGroupBox *viewGroup = new QGroupBox("Visualizer Controls");
         QVBoxLayout *viewLayout = new QVBoxLayout(viewGroup);
@@ -221,13 +2150,73 @@ public:
         pauseBtn->setCheckable(true);
         
         QPushButton *resetZoomBtn = new QPushButton("RESET ZOOM");
+
+        scopeCombo = new QComboBox();
+        scopeCombo->addItem("Scope: TX Waveform");
+        scopeCombo->addItem("Scope: RX Stream");
+        scopeCombo->addItem("Scope: Channelizer Output");
+
+        specFftCombo = new QComboBox();
+        for (int n = 2048; n <= 65536; n *= 2) specFftCombo->addItem(QString("Spectrum FFT: %1").arg(n), n);
+
+        specReduceCombo = new QComboBox();
+        specReduceCombo->addItem("Bins/Pixel: Peak");
+        specReduceCombo->addItem("Bins/Pixel: Average");
+        specReduceCombo->addItem("Bins/Pixel: Min/Max");
+
+        freezeDepthBox = new QSpinBox();
+        freezeDepthBox->setRange(0, 30);
+        freezeDepthBox->setValue(2);
+        freezeDepthBox->setPrefix("Freeze history: ");
+        freezeDepthBox->setSuffix(" s");
+        freezeDepthBox->setToolTip("RX kept for scrubbing while paused, within half the memory limit; applies on connect");
+        freezeSlider = new QSlider(Qt::Horizontal);
+        freezeSlider->setEnabled(false);
+        freezeLabel = new QLabel("Freeze: live");
+        freezeLabel->setWordWrap(true);
         
+        viewLayout->addWidget(scopeCombo);
+        viewLayout->addWidget(specFftCombo);
+        viewLayout->addWidget(specReduceCombo);
+        viewLayout->addWidget(freezeDepthBox);
         viewLayout->addWidget(pauseBtn);
+        viewLayout->addWidget(freezeSlider);
+        viewLayout->addWidget(freezeLabel);
         viewLayout->addWidget(resetZoomBtn);
         panelLayout->addWidget(viewGroup);
         
+        // Diagnostics Group
+        QGroupBox *diagGroup = new QGroupBox("Diagnostics");
+        QVBoxLayout *diagLayout = new QVBoxLayout(diagGroup);
+        startupLabel = new QLabel("Startup: --");
+        diagLayout->addWidget(startupLabel);
+        memoryLabel = new QLabel("Huge pages: --");
+        memoryLabel->setWordWrap(true);
+        diagLayout->addWidget(memoryLabel);
+        tasksLabel = new QLabel("Analysis: --");
+        tasksLabel->setWordWrap(true);
+        diagLayout->addWidget(tasksLabel);
+        QFormLayout *budgetForm = new QFormLayout();
+        memLimitBox = new QSpinBox();
+        memLimitBox->setRange(16, 16384);
+        memLimitBox->setValue(256);
+        memLimitBox->setSuffix(" MB");
+        memLimitBox->setToolTip("Cached waveforms are evicted to stay under this");
+        budgetForm->addRow("Memory Limit:", memLimitBox);
+        diagLayout->addLayout(budgetForm);
+        budgetLabel = new QLabel("Budget: --");
+        budgetLabel->setWordWrap(true);
+        diagLayout->addWidget(budgetLabel);
+        panelLayout->addWidget(diagGroup);
+
         panelLayout->addStretch();
-        mainLayout->addWidget(controlPanel);
+
+        // The deck outgrew the window height, so it scrolls
+        QScrollArea *controlScroll = new QScrollArea();
+        controlScroll->setWidget(controlPanel);
+        controlScroll->setWidgetResizable(true);
+        controlScroll->setFixedWidth(300);
+        mainLayout->addWidget(controlScroll);
 
         // -- RIGHT PANEL (Chart) --
         chart = new QChart();
@@ -262,7 +2251,91 @@ public:
         
         // Use custom view for Zooming
         ZoomableChartView *chartView = new ZoomableChartView(chart);
-        mainLayout->addWidget(chartView);
+
+        // -- SPECTRUM (RX) --
+        specChart = new QChart();
+        specChart->setTheme(QChart::ChartThemeDark);
+
+        specSeries = new QLineSeries();
+        specSeries->setName("RX Spectrum");
+        QPen penS(QColor(0, 191, 255)); // Deep Sky Blue
+        specSeries->setPen(penS);
+
+        thresholdSeries = new QLineSeries();
+        thresholdSeries->setName("Detect Threshold");
+        QPen penT(QColor(255, 234, 0));
+        penT.setStyle(Qt::DashLine);
+        thresholdSeries->setPen(penT);
+
+        maskSeries = new QLineSeries();
+        maskSeries->setName("Emission Mask");
+        QPen penM(QColor(255, 82, 82));
+        penM.setStyle(Qt::DashLine);
+        maskSeries->setPen(penM);
+
+        specChart->addSeries(specSeries);
+        specChart->addSeries(thresholdSeries);
+        specChart->addSeries(maskSeries);
+        specChart->createDefaultAxes();
+
+        QValueAxis *specX = qobject_cast<QValueAxis*>(specChart->axes(Qt::Horizontal).first());
+        specX->setRange(-500, 500);
+        specX->setTitleText("Offset (kHz)");
+
+        QValueAxis *specY = qobject_cast<QValueAxis*>(specChart->axes(Qt::Vertical).first());
+        specY->setRange(-120, 10);
+        specY->setTitleText("Power (dBFS)");
+        specChart->setTitle("Receive Spectrum");
+
+        specView = new ZoomableChartView(specChart);
+        connect(specX, &QValueAxis::rangeChanged, this, [=](double, double){ renderSpectrum(); });
+
+        // -- PANORAMA (stitched sweep, only shown while scanning) --
+        panoChart = new QChart();
+        panoChart->setTheme(QChart::ChartThemeDark);
+
+        panoSeries = new QLineSeries();
+        panoSeries->setName("Panorama (peak per column)");
+        QPen penP(QColor(255, 145, 0));
+        panoSeries->setPen(penP);
+
+        panoChart->addSeries(panoSeries);
+        panoChart->createDefaultAxes();
+        qobject_cast<QValueAxis*>(panoChart->axes(Qt::Horizontal).first())->setTitleText("Frequency (MHz)");
+        QValueAxis *panoY = qobject_cast<QValueAxis*>(panoChart->axes(Qt::Vertical).first());
+        panoY->setRange(-120, 10);
+        panoY->setTitleText("Power (dBFS)");
+        panoChart->setTitle("Panorama Sweep");
+
+        panoView = new ZoomableChartView(panoChart);
+        panoView->setVisible(false);
+
+        // -- ZOOM FFT (only shown while running) --
+        zoomChart = new QChart();
+        zoomChart->setTheme(QChart::ChartThemeDark);
+
+        zoomSeries = new QLineSeries();
+        zoomSeries->setName("Zoom FFT");
+        QPen penZ(QColor(118, 255, 3));
+        zoomSeries->setPen(penZ);
+
+        zoomChart->addSeries(zoomSeries);
+        zoomChart->createDefaultAxes();
+        qobject_cast<QValueAxis*>(zoomChart->axes(Qt::Horizontal).first())->setTitleText("Offset from zoom center (Hz)");
+        QValueAxis *zoomY = qobject_cast<QValueAxis*>(zoomChart->axes(Qt::Vertical).first());
+        zoomY->setRange(-140, 10);
+        zoomY->setTitleText("Power (dBFS)");
+        zoomChart->setTitle("Zoom FFT");
+
+        zoomView = new ZoomableChartView(zoomChart);
+        zoomView->setVisible(false);
+
+        QVBoxLayout *plotLayout = new QVBoxLayout();
+        plotLayout->addWidget(chartView);
+        plotLayout->addWidget(specView);
+        plotLayout->addWidget(panoView);
+        plotLayout->addWidget(zoomView);
+        mainLayout->addLayout(plotLayout);
 
         setCentralWidget(centralWidget);
         resize(1200, 700);
@@ -276,16 +2349,201 @@ public:
             isPaused = checked; 
             pauseBtn->setText(checked ? "RESUME VIEW" : "PAUSE VIEW");
             pauseBtn->setStyleSheet(checked ? "background-color: #F57C00;" : "");
+            if (checked) freezeView();
+            else thawView();
         });
+        connect(freezeSlider, &QSlider::valueChanged, [=](int v){ if (!frozen.frames.empty()) showFrozen(v); });
+        connect(freezeDepthBox, QOverload<int>::of(&QSpinBox::valueChanged),
+                [=](int v){ worker->freeze_seconds = v; });
 
         connect(freqBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
-                [=](double v){ worker->frequency = v; });
+                [=](double v){ worker->frequency = v; worker->noteControlChange(); });
         connect(gainBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
-                [=](double v){ worker->gain = v; });
+                [=](double v){ worker->gain = v; worker->noteControlChange(); });
         connect(ampBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
-                [=](double v){ worker->amplitude = v; });
+                [=](double v){ worker->amplitude = v; worker->noteControlChange(); });
         connect(waveCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
-                [=](int idx){ worker->waveform_type = idx; });
+                [=](int idx){ worker->waveform_type = idx; worker->noteControlChange(); });
+        connect(scanBtn, &QPushButton::clicked, [=](){
+            scanBtn->setEnabled(false);
+            refreshDevices();
+            scanBtn->setEnabled(true);
+        });
+        connect(tuneBtn, &QPushButton::clicked, [=](){
+            QString args = deviceCombo->currentData().toString();
+            std::unique_ptr<RadioBackend> radio;
+            if (args.isEmpty()) {
+                radio.reset(new SimTransportBackend());
+            } else {
+                std::string error;
+                CreateRadioBackendFn create = BackendPlugin::uhd(error);
+                if (!create) {
+                    transportLabel->setText("Transport: " + QString::fromStdString(error));
+                    return;
+                }
+                radio.reset(create());
+            }
+            RadioConfig config{1e6, freqBox->value(), gainBox->value(), rxGainBox->value()};
+            tuneArgs = args;
+            tuner.start(std::move(radio), args.toStdString(), config);
+            tuneBtn->setEnabled(false);
+            connectBtn->setEnabled(false);
+        });
+        connect(deviceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){
+            showTransport(loadTransport(deviceCombo->currentData().toString()));
+        });
+        connect(lowLatencyCheck, &QCheckBox::toggled, [=](bool checked){ worker->low_latency = checked; });
+        connect(cacheBudgetBox, QOverload<int>::of(&QSpinBox::valueChanged), 
+                [=](int mb){ worker->waveforms.setBudget(size_t(mb) << 20); });
+        connect(memLimitBox, QOverload<int>::of(&QSpinBox::valueChanged), 
+                [=](int mb){ worker->memory_budget.setLimit(size_t(mb) << 20); });
+        connect(maskSaveCheck, &QCheckBox::toggled, [=](bool checked){ worker->mask_save = checked; });
+        connect(maskBtn, &QPushButton::toggled, [=](bool checked){
+            if (checked) {
+                worker->data_mutex.lock();
+                worker->mask_spec = maskEdit->text();
+                worker->mask_relative = maskUnitCombo->currentIndex() == 0;
+                worker->data_mutex.unlock();
+                worker->mask_seq++;
+            }
+            worker->mask_enabled = checked;
+            maskEdit->setEnabled(!checked);
+            maskUnitCombo->setEnabled(!checked);
+            maskBtn->setText(checked ? "STOP MASK TEST" : "START MASK TEST");
+            maskBtn->setStyleSheet(checked ? "background-color: #C62828;" : "");
+        });
+        connect(rxGainBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->rx_gain = v; });
+        connect(agcCheck, &QCheckBox::toggled, [=](bool checked){ worker->agc_enabled = checked; });
+        connect(agcTargetBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                [=](double v){ worker->agc_target_dbfs = v; });
+        connect(thresholdBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->detect_threshold = v; });
+        connect(detectBtn, &QPushButton::toggled, [=](bool checked){
+            if (checked && !eventLog.is_open()) {
+                openCsvLog(eventLog, "detections.csv", "time_s,start_hz,stop_hz,peak_dbfs,noise_floor_dbfs,rx_gain_db");
+            }
+            worker->detector_enabled = checked;
+            detectBtn->setText(checked ? "DISABLE DETECTOR" : "ENABLE DETECTOR");
+            detectBtn->setStyleSheet(checked ? "background-color: #00838F;" : "");
+        });
+        connect(panoBtn, &QPushButton::toggled, [=](bool checked){
+            double start = std::min(panoStartBox->value(), panoStopBox->value());
+            double stop = std::max(panoStartBox->value(), panoStopBox->value());
+            worker->pano_start = start * 1e6;
+            worker->pano_stop = stop * 1e6;
+            worker->panorama_enabled = checked;
+            panoView->setVisible(checked);
+            panoBtn->setText(checked ? "STOP PANORAMA" : "START PANORAMA");
+            panoBtn->setStyleSheet(checked ? "background-color: #EF6C00;" : "");
+        });
+        auto applyZoom = [=]() {
+            worker->zoom_center = zoomCenterBox->value() * 1e3;
+            worker->zoom_span = zoomSpanBox->value();
+            worker->zoom_fft_size = zoomSizeCombo->currentData().toInt();
+            worker->zoom_seq++;
+        };
+        connect(zoomCenterBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), [=](double){ applyZoom(); });
+        connect(zoomSpanBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), [=](double){ applyZoom(); });
+        connect(zoomSizeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){ applyZoom(); });
+        connect(zoomFromViewBtn, &QPushButton::clicked, [=](){
+            QValueAxis *x = qobject_cast<QValueAxis*>(specChart->axes(Qt::Horizontal).first());
+            zoomCenterBox->setValue((x->min() + x->max()) / 2);
+            zoomSpanBox->setValue((x->max() - x->min()) * 1e3);
+        });
+        connect(zoomBtn, &QPushButton::toggled, [=](bool checked){
+            applyZoom();
+            worker->zoom_enabled = checked;
+            zoomView->setVisible(checked);
+            zoomBtn->setText(checked ? "STOP ZOOM" : "START ZOOM");
+            zoomBtn->setStyleSheet(checked ? "background-color: #558B2F;" : "");
+        });
+        connect(zoomFrozenBtn, &QPushButton::clicked, [=](){ zoomFrozen(freezeSlider->value()); });
+        connect(chanCountCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){
+            int m = chanCountCombo->currentData().toInt();
+            worker->channel_count = m;
+            chanSelectBox->setRange(0, m - 1);
+        });
+        connect(chanOsCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
+                [=](int){ worker->channel_oversample = chanOsCombo->currentData().toInt(); });
+        connect(chanSelectBox, QOverload<int>::of(&QSpinBox::valueChanged), 
+                [=](int v){ worker->scope_channel = v; });
+        connect(chanRecordCheck, &QCheckBox::toggled, [=](bool checked){
+            worker->channel_record_failed = false;
+            worker->channel_record = checked;
+        });
+        connect(scopeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
+                [=](int idx){ worker->scope_source = idx; });
+        connect(specFftCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                [=](int){ worker->spectrum_fft_size = specFftCombo->currentData().toInt(); });
+        connect(specReduceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                [=](int){ renderSpectrum(); });
+        connect(fmModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
+                [=](int idx){ worker->fm_mode = idx; });
+        connect(fmOffsetBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->fm_offset = v * 1e3; });
+        connect(fmBtn, &QPushButton::toggled, [=](bool checked){
+            worker->data_mutex.lock();
+            worker->fm_target = fmTargetEdit->text();
+            worker->data_mutex.unlock();
+            worker->fm_enabled = checked;
+            fmTargetEdit->setEnabled(!checked);
+            fmBtn->setText(checked ? "STOP DEMOD" : "START DEMOD");
+            fmBtn->setStyleSheet(checked ? "background-color: #AD1457;" : "");
+        });
+        connect(corrThreshBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->correlator_threshold = v; });
+        connect(triggerCheck, &QCheckBox::toggled, [=](bool checked){ worker->scope_trigger = checked; });
+        connect(corrBtn, &QPushButton::toggled, [=](bool checked){
+            worker->data_mutex.lock();
+            worker->preamble_file = refFileEdit->text();
+            worker->data_mutex.unlock();
+            worker->correlator_enabled = checked;
+            refFileEdit->setEnabled(!checked);
+            corrBtn->setText(checked ? "STOP CORRELATOR" : "START CORRELATOR");
+            corrBtn->setStyleSheet(checked ? "background-color: #283593;" : "");
+        });
+        connect(dbSearchBtn, &QPushButton::clicked, this, &MainWindow::searchEvents);
+        connect(dbResultList, &QListWidget::itemDoubleClicked, [=](QListWidgetItem *item){
+            int row = dbResultList->row(item);
+            if (row >= 0 && row < (int)searchHits.size()) showHit(searchHits[row]);
+        });
+        connect(captureCheck, &QCheckBox::toggled, [=](bool checked){ worker->capture_enabled = checked; });
+        connect(captureRingBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->capture_ring_s = v; });
+        connect(capturePreBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->capture_pre_s = v; });
+        connect(capturePostBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->capture_post_s = v; });
+        connect(captureDetCheck, &QCheckBox::toggled, [=](bool checked){ worker->capture_on_detection = checked; });
+        connect(capturePreambleCheck, &QCheckBox::toggled, [=](bool checked){ worker->capture_on_preamble = checked; });
+        connect(captureMaskCheck, &QCheckBox::toggled, [=](bool checked){ worker->capture_on_mask = checked; });
+        connect(captureFaultCheck, &QCheckBox::toggled, [=](bool checked){ worker->capture_on_fault = checked; });
+        connect(captureNowBtn, &QPushButton::clicked, [=](){ worker->capture_now = true; });
+        connect(relayCheck, &QCheckBox::toggled, [=](bool checked){ worker->relay_mode = checked; });
+        connect(dpdCheck, &QCheckBox::toggled, [=](bool checked){ worker->dpd_enabled = checked; });
+        connect(dpdAdaptCheck, &QCheckBox::toggled, [=](bool checked){ worker->dpd_adapt = checked; });
+        connect(simPaCheck, &QCheckBox::toggled, [=](bool checked){ worker->sim_pa = checked; });
+        connect(dpdResetBtn, &QPushButton::clicked, [=](){ worker->dpd_reset = true; });
+        connect(iqCorrectCheck, &QCheckBox::toggled, [=](bool checked){ worker->iq_correct = checked; });
+        connect(simIqCheck, &QCheckBox::toggled, [=](bool checked){ worker->sim_iq_error = checked; });
+        connect(iqCalBtn, &QPushButton::clicked, [=](){ worker->iq_calibrate = true; });
+        connect(relayShiftBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->relay_shift = v * 1e3; });
+        connect(relayGainBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->relay_gain = v; });
+        connect(relayFilterCheck, &QCheckBox::toggled, [=](bool checked){ worker->relay_filter = checked; });
+        connect(relayCutoffBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                [=](double v){ worker->relay_cutoff = v * 1e3; });
+        connect(chanBtn, &QPushButton::toggled, [=](bool checked){
+            worker->channelizer_enabled = checked;
+            chanBtn->setText(checked ? "DISABLE CHANNELIZER" : "ENABLE CHANNELIZER");
+            chanBtn->setStyleSheet(checked ? "background-color: #6A1B9A;" : "");
+        });
+
+        if (eventStore.open("events.evdb")) dbLabel->setText(QString("Stored: %1 events").arg((qulonglong)eventStore.size()));
+        else dbLabel->setText("Stored: events.evdb could not be opened");
+        eventSyncTimer.start();
 
         // --- TIMER ---
         timer = new QTimer(this);
@@ -312,14 +2570,92 @@ public:
         qApp->setPalette(p);
     }
 
+    // Loads the UHD plugin on first use; until then only simulation is offered
     void refreshDevices() {
         deviceCombo->clear();
         deviceCombo->addItem("Simulation Mode");
-        uhd::device_addrs_t devices = uhd::device::find(uhd::device_addr_t(""));
-        for (const auto &dev : devices) {
-            std::string label = dev.get("type") + " (" + dev.get("serial") + ")";
-            deviceCombo->addItem(QString::fromStdString(label), QString::fromStdString(dev.to_string()));
+        std::string error;
+        CreateRadioBackendFn create = BackendPlugin::uhd(error);
+        if (!create) {
+            statusLabel->setText("UHD PLUGIN MISSING");
+            statusLabel->setToolTip(QString::fromStdString(error));
+            return;
         }
+        std::unique_ptr<RadioBackend> probe(create());
+        for (const auto &dev : probe->findDevices()) {
+            deviceCombo->addItem(QString::fromStdString(dev.label), QString::fromStdString(dev.args));
+        }
+        statusLabel->setText(QString("FOUND %1 DEVICE(S)").arg(deviceCombo->count() - 1));
+    }
+
+    // Tuned profiles are stored per device serial; an address without one
+    // is used as is, and simulation has its own entry
+    static QString deviceKey(const QString &args) {
+        if (args.isEmpty()) return "simulation";
+        for (const QString &part : args.split(',')) {
+            if (part.startsWith("serial=")) return part.mid(7);
+        }
+        return args;
+    }
+
+    TransportProfile loadTransport(const QString &args) {
+        QSettings settings("usrp_viz", "usrp_viz");
+        settings.beginGroup("transport/" + deviceKey(args));
+        TransportProfile p;
+        p.block = settings.value("block", 0).toULongLong();
+        p.spp = settings.value("spp", 0).toULongLong();
+        p.frames = settings.value("frames", 0).toULongLong();
+        p.buff_bytes = settings.value("buff_bytes", 0).toULongLong();
+        p.cpu = settings.value("cpu", 0.0).toDouble();
+        p.latency_ms = settings.value("latency_ms", 0.0).toDouble();
+        p.latency_measured = settings.value("latency_measured", false).toBool();
+        p.underflows = settings.value("underflows", 0).toULongLong();
+        settings.endGroup();
+        return p;
+    }
+
+    void saveTransport(const QString &args, const TransportProfile &p) {
+        QSettings settings("usrp_viz", "usrp_viz");
+        settings.beginGroup("transport/" + deviceKey(args));
+        settings.setValue("block", (qulonglong)p.block);
+        settings.setValue("spp", (qulonglong)p.spp);
+        settings.setValue("frames", (qulonglong)p.frames);
+        settings.setValue("buff_bytes", (qulonglong)p.buff_bytes);
+        settings.setValue("cpu", p.cpu);
+        settings.setValue("latency_ms", p.latency_ms);
+        settings.setValue("latency_measured", p.latency_measured);
+        settings.setValue("underflows", (qulonglong)p.underflows);
+        settings.endGroup();
+    }
+
+    void showTransport(const TransportProfile &p) {
+        if (!p.valid()) {
+            transportLabel->setText("Transport: defaults (not tuned)");
+            return;
+        }
+        transportLabel->setText(QString("Transport: %1 spp, %2 frames, %3 buffer, %4 per send\n"
+                                        "%5 ms in flight (%8), %6% CPU, %7 underflows")
+                                    .arg(p.spp ? QString::number(p.spp) : QString("default"))
+                                    .arg(p.frames)
+                                    .arg(p.buff_bytes ? QString("%1 KB").arg(p.buff_bytes >> 10) : QString("default"))
+                                    .arg(p.block)
+                                    .arg(p.latency_ms, 0, 'f', 2)
+                                    .arg(p.cpu * 100, 0, 'f', 0)
+                                    .arg((qulonglong)p.underflows)
+                                    .arg(p.latency_measured ? "measured" : "queue size, not measured"));
+    }
+
+    // For --startup-time: start the simulation, report when the first frame
+    // is drawn, then quit
+    void measureStartup() {
+        exit_after_startup = true;
+        toggleConnection();
+    }
+
+    // F9 saves the capture ring around "now" without reaching for the mouse
+    void keyPressEvent(QKeyEvent *event) override {
+        if (event->key() == Qt::Key_F9 && !event->isAutoRepeat()) worker->capture_now = true;
+        else QMainWindow::keyPressEvent(event);
     }
 
     void toggleConnection() {
@@ -328,12 +2664,15 @@ public:
             worker->wait();
             connectBtn->setText("INITIALIZE SYSTEM");
             connectBtn->setChecked(false);
+            tuneBtn->setEnabled(true);
             statusLabel->setText("STATUS: STANDBY");
             statusLabel->setStyleSheet("color: #757575; font-weight: bold; border: 1px solid #424242; padding: 5px;");
         } else {
             QString args = deviceCombo->currentData().toString();
             worker->device_args = args;
+            worker->transport = loadTransport(args);
             worker->running = true;
+            tuneBtn->setEnabled(false);
             worker->start();
             
             QTimer::singleShot(500, this, [=]() {
@@ -352,31 +2691,1114 @@ public:
         }
     }
 
+    // Which views are being drawn, for the worker to skip the rest. A
+    // paused, minimized or never-shown (headless) window draws none.
+    void updateConsumers() {
+        unsigned c = 0;
+        if (!isPaused && isVisible() && !isMinimized()) {
+            c = RadioWorker::ScopeView | RadioWorker::SpectrumView;
+            if (zoomView->isVisible()) c |= RadioWorker::ZoomView;
+            if (panoView->isVisible()) c |= RadioWorker::PanoramaView;
+        }
+        worker->consumers = c;
+    }
+
+    // Runs the radio without a window: detections, captures and audio
+    // carry on, and the worker skips everything that only feeds a view
+    void startHeadless() {
+        updateConsumers();
+        toggleConnection();
+    }
+
     void updatePlot() {
-        if (isPaused) return; // Don't update if paused
+        drainEvents(); // Detections are logged even while the view is paused
+        updateReadouts();
+        updateConsumers();
+        if (worker->consumers == 0) return; // Paused, minimized or headless
 
         std::vector<std::complex<float>> local_data;
+        SpectrumRef local_spectrum;
+        std::vector<float> local_mask;
+        std::vector<float> local_zoom;
+        double zoom_span = 0;
+        std::vector<float> local_panorama;
+        double pano_lo = 0, pano_hi = 0;
         worker->data_mutex.lock();
-        if(!worker->shared_buffer.empty()) local_data = worker->shared_buffer;
+        if (worker->relay_view) local_data.assign(worker->relay_view->data, worker->relay_view->data + worker->relay_view->size);
+        else if(!worker->shared_buffer.empty()) local_data = worker->shared_buffer;
+        local_spectrum = worker->shared_spectrum;
+        local_mask = worker->shared_mask;
+        if (worker->zoom_enabled) {
+            local_zoom.swap(worker->shared_zoom);
+            zoom_span = worker->zoom_span_hz;
+        }
+        if (worker->panorama_enabled) {
+            local_panorama.swap(worker->shared_panorama);
+            pano_lo = worker->panorama_start_hz;
+            pano_hi = worker->panorama_stop_hz;
+        }
         worker->data_mutex.unlock();
 
+        if (local_spectrum) updateSpectrum(local_spectrum->psd_db, local_mask);
+        updatePanorama(local_panorama, pano_lo, pano_hi);
+        updateZoom(local_zoom, zoom_span);
+
         if(local_data.empty()) return;
+        drawScope(local_data);
+
+        if (startup_ms < 0) {
+            startup_ms = msSinceProcessStart();
+            startupLabel->setText(QString("Startup: first frame %1 ms after launch").arg(startup_ms, 0, 'f', 0));
+            if (exit_after_startup) {
+                printf("first frame: %.0f ms after process start\n", startup_ms);
+                worker->running = false;
+                worker->wait();
+                QTimer::singleShot(0, qApp, &QApplication::quit);
+            }
+        }
+    }
 
+    void drawScope(const std::vector<std::complex<float>> &data) {
         QList<QPointF> pI, pQ;
         // Limit points for performance, but take enough for a good wave
-        int limit = std::min((int)local_data.size(), 500); 
+        int limit = std::min((int)data.size(), scope_points);
         for(int i=0; i<limit; ++i) {
-            pI.append(QPointF(i, local_data[i].real()));
-            pQ.append(QPointF(i, local_data[i].imag()));
+            pI.append(QPointF(i, data[i].real()));
+            pQ.append(QPointF(i, data[i].imag()));
         }
         seriesI->replace(pI);
         seriesQ->replace(pQ);
     }
+
+    // Stops the worker's history and lets the slider scrub what it held.
+    // The snapshot shares the pooled blocks, so pausing copies nothing.
+    void freezeView() {
+        if (!worker->isRunning() || worker->relay_mode) return;
+        frozen = worker->history.freeze();
+        if (frozen.frames.empty()) {
+            freezeLabel->setText("Freeze: nothing recorded (history off?)");
+            return;
+        }
+        const AnalysisFrame &last = *frozen.frames.back();
+        uint64_t held = last.first_index + last.block->size - frozen.frames.front()->first_index;
+        int range = int(std::min<uint64_t>(held - std::min<uint64_t>(held, scope_points), std::numeric_limits<int>::max()));
+        freezeSlider->setRange(0, range);
+        freezeSlider->setEnabled(true);
+        freezeSlider->setValue(range); // Opens on the newest samples
+        zoomFrozenBtn->setEnabled(true);
+        showFrozen(range);
+    }
+
+    void thawView() {
+        worker->history.thaw();
+        frozen = FrameHistory::Snapshot();
+        freezeSlider->setEnabled(false);
+        zoomFrozenBtn->setEnabled(false);
+        zoomView->setVisible(zoomBtn->isChecked());
+        freezeLabel->setText(worker->freeze_capped || worker->history.shrunk() ? "Freeze: live, depth capped by the memory limit" : "Freeze: live");
+    }
+
+    // Draws the scope and spectrum as they were 'offset' samples into the
+    // frozen history, with a few measurements taken on the spot
+    void showFrozen(int offset) {
+        const auto &frames = frozen.frames;
+        uint64_t target = frames.front()->first_index + uint64_t(offset);
+
+        auto it = std::upper_bound(frames.begin(), frames.end(), target,
+                                   [](uint64_t t, const FrameRef &f) { return t < f->first_index; });
+        if (it != frames.begin()) --it;
+        double time_s = (*it)->time_s - frames.back()->time_s;
+        double gain_db = (*it)->rx_gain_db;
+        std::vector<std::complex<float>> samples;
+        gatherFrozen(target, scope_points, samples);
+
+        QString text = QString("Frozen at %1 s, RX gain %2 dB: ").arg(time_s, 0, 'f', 3).arg(gain_db, 0, 'f', 0);
+        if (samples.empty()) {
+            text += "samples dropped here";
+        } else {
+            drawScope(samples);
+            double sum = 0, peak = 0;
+            for (const auto &x : samples) {
+                double p = std::norm(x);
+                sum += p;
+                peak = std::max(peak, p);
+            }
+            text += QString("mean %1 dBFS, peak %2 dBFS")
+                        .arg(10 * std::log10(sum / samples.size() + 1e-20), 0, 'f', 1)
+                        .arg(10 * std::log10(peak + 1e-20), 0, 'f', 1);
+        }
+
+        // The spectrum covering that moment. Spectra are only kept while
+        // the spectrum view is shown, so without one it is computed from
+        // the held samples.
+        const auto &spectra = frozen.spectra;
+        auto sp = std::upper_bound(spectra.begin(), spectra.end(), target,
+                                   [](uint64_t t, const SpectrumRef &s) { return t < s->first_index; });
+        if (sp != spectra.begin()) --sp;
+        std::vector<float> computed;
+        const std::vector<float> *psd = nullptr;
+        if (sp != spectra.end() && (*sp)->first_index <= target && target < (*sp)->first_index + (*sp)->psd_db.size()) {
+            psd = &(*sp)->psd_db;
+        } else {
+            // Near the newest samples the FFT ends there instead
+            size_t fft_size = worker->spectrum_fft_size.load();
+            uint64_t held_end = frames.back()->first_index + frames.back()->block->size;
+            uint64_t from = std::max(frames.front()->first_index, std::min(target, held_end - std::min<uint64_t>(held_end, fft_size)));
+            std::vector<std::complex<float>> window;
+            gatherFrozen(from, fft_size, window);
+            if (window.size() == fft_size) {
+                if (frozen_analyzer.size() != fft_size) frozen_analyzer.configure(fft_size);
+                frozen_analyzer.process(window.data(), computed);
+                psd = &computed;
+            }
+        }
+        if (psd && !psd->empty()) {
+            updateSpectrum(*psd, std::vector<float>());
+            size_t bin = std::max_element(psd->begin(), psd->end()) - psd->begin();
+            const double rate_khz = 1e3;
+            text += QString("\nSpectrum peak %1 dBFS at %2 kHz%3")
+                        .arg((*psd)[bin], 0, 'f', 1)
+                        .arg(-rate_khz / 2 + bin * rate_khz / psd->size(), 0, 'f', 1)
+                        .arg(psd == &computed ? " (computed from the held samples)" : "");
+        }
+
+        text += QString("\nHeld: %1 s, %2 frames, %3 spectra, %4 MB")
+                    .arg(frames.back()->time_s - frames.front()->time_s, 0, 'f', 2)
+                    .arg(frames.size())
+                    .arg(spectra.size())
+                    .arg(frozen.bytes / 1e6, 0, 'f', 1);
+        if (worker->freeze_capped || worker->history.shrunk()) text += " (depth capped by the memory limit)";
+        freezeLabel->setText(text);
+    }
+
+    // Copies up to 'count' gapless samples from stream index 'from' out of
+    // the frozen frames
+    void gatherFrozen(uint64_t from, size_t count, std::vector<std::complex<float>> &out) const {
+        const auto &frames = frozen.frames;
+        auto it = std::upper_bound(frames.begin(), frames.end(), from,
+                                   [](uint64_t t, const FrameRef &f) { return t < f->first_index; });
+        if (it != frames.begin()) --it;
+        out.clear();
+        uint64_t next = from;
+        for (; it != frames.end() && out.size() < count; ++it) {
+            const AnalysisFrame &f = **it;
+            if (f.first_index > next) break; // Overflow gap
+            size_t skip = next - f.first_index;
+            if (skip >= f.block->size) continue;
+            size_t take = std::min(f.block->size - skip, count - out.size());
+            out.insert(out.end(), f.block->data + skip, f.block->data + skip + take);
+            next += take;
+        }
+    }
+
+    // Runs the zoom settings over the frozen history up to 'offset' (the
+    // slider), from the last gap on, and shows the newest spectrum
+    void zoomFrozen(int offset) {
+        const auto &frames = frozen.frames;
+        if (frames.empty()) return;
+        const double rate = 1e6;
+        uint64_t end = frames.front()->first_index + uint64_t(offset) + scope_points;
+        ZoomFft zoom;
+        std::vector<float> psd, latest;
+        uint64_t next = 0;
+        bool started = false;
+        for (const auto &f : frames) {
+            if (f->first_index >= end) break;
+            if (!started || f->first_index != next) {
+                zoom.configure(rate, zoomCenterBox->value() * 1e3, zoomSpanBox->value(),
+                               zoomSizeCombo->currentData().toInt(), 4);
+                started = true;
+            }
+            next = f->first_index + f->block->size;
+            size_t n = size_t(std::min<uint64_t>(f->block->size, end - f->first_index));
+            if (zoom.process(f->block->data, n, psd)) latest = psd;
+        }
+        if (latest.empty()) {
+            zoomLabel->setText(QString("Frozen: too few gapless samples held for a %1-point zoom")
+                                   .arg(zoomSizeCombo->currentData().toInt()));
+            return;
+        }
+        zoomView->setVisible(true);
+        updateZoom(latest, zoom.outputRate());
+        zoomLabel->setText(QString("Frozen: RBW %1 Hz").arg(zoom.resolution(), 0, 'g', 3));
+    }
+
+    void updateSpectrum(const std::vector<float> &psd_db, const std::vector<float> &mask_db) {
+        if (psd_db.empty()) return;
+
+        const double rate_khz = 1e3;
+        specBins = psd_db;
+        renderSpectrum();
+
+        if (worker->detector_enabled) {
+            float limit = worker->noise_floor_db.load() + worker->detect_threshold.load();
+            QList<QPointF> pT;
+            pT.append(QPointF(-rate_khz / 2, limit));
+            pT.append(QPointF(rate_khz / 2, limit));
+            thresholdSeries->replace(pT);
+        } else {
+            thresholdSeries->clear();
+        }
+
+        QList<QPointF> pM;
+        double mask_bin_khz = mask_db.empty() ? 0.0 : rate_khz / mask_db.size();
+        for (size_t i = 0; i < mask_db.size(); i++) {
+            pM.append(QPointF(-rate_khz / 2 + i * mask_bin_khz, mask_db[i]));
+        }
+        maskSeries->replace(pM);
+    }
+
+    // Draws the visible part of the latest spectrum at about one point per
+    // pixel, so a 64k FFT costs no more to plot than a 2k one.
+    void renderSpectrum() {
+        if (specBins.empty()) return;
+        const double rate_khz = 1e3;
+        double bin_khz = rate_khz / specBins.size();
+        QValueAxis *x = qobject_cast<QValueAxis*>(specChart->axes(Qt::Horizontal).first());
+        double lo = std::max(0.0, (x->min() + rate_khz / 2) / bin_khz);
+        double hi = std::min<double>(specBins.size(), (x->max() + rate_khz / 2) / bin_khz + 1);
+        if (hi <= lo) return;
+        size_t columns = std::max(200, specView->width());
+        BinReducer::reduce(specBins.data(), size_t(lo), size_t(std::ceil(hi)), columns,
+                           BinReducer::Mode(specReduceCombo->currentIndex()), reducedPos, reducedVal);
+        QList<QPointF> pS;
+        pS.reserve(reducedVal.size());
+        for (size_t i = 0; i < reducedVal.size(); i++) {
+            pS.append(QPointF(-rate_khz / 2 + reducedPos[i] * bin_khz, reducedVal[i]));
+        }
+        specSeries->replace(pS);
+    }
+
+    // Status text that tracks the worker regardless of the plot
+    void updateReadouts() {
+        TransportProfile tuned;
+        std::string tune_error;
+        if (tuner.running()) {
+            transportLabel->setText(QString("Transport: tuning, trial %1 of %2")
+                                        .arg(tuner.trialsDone() + 1).arg(tuner.trialCount()));
+        } else if (tuner.takeResult(tuned, tune_error)) {
+            if (tuned.valid()) saveTransport(tuneArgs, tuned);
+            showTransport(loadTransport(tuneArgs));
+            if (!tune_error.empty()) transportLabel->setText(transportLabel->text() + "\nTuning failed: " + QString::fromStdString(tune_error));
+            tuneBtn->setEnabled(true);
+            connectBtn->setEnabled(true);
+        }
+
+        memoryLabel->setText(QString("Sample memory: %1 MB explicit huge, %2 MB THP, %3 MB 4K pages%4\n"
+                                     "Small buffers: %5 MB in use on %6 MB of shared pages")
+                                 .arg(HugePages::bytesMapped(HugePages::Explicit) / 1048576.0, 0, 'f', 1)
+                                 .arg(HugePages::bytesMapped(HugePages::Transparent) / 1048576.0, 0, 'f', 1)
+                                 .arg(HugePages::bytesMapped(HugePages::Normal) / 1048576.0, 0, 'f', 1)
+                                 .arg(HugePages::enabled ? "" : " (huge pages off)")
+                                 .arg(HugePageArena::bytesInUse() / 1048576.0, 0, 'f', 2)
+                                 .arg(HugePageArena::bytesMapped() / 1048576.0, 0, 'f', 0));
+
+        if (worker->isRunning() && !worker->relay_mode) {
+            worker->data_mutex.lock();
+            std::vector<AnalysisScheduler::TaskStats> tasks = worker->shared_task_stats;
+            worker->data_mutex.unlock();
+            uint64_t starved = worker->analysis_starved.load();
+            QString text = QString("Analysis: %1 threads, %2 frames unanalyzed")
+                               .arg((qulonglong)worker->analysis_threads.load())
+                               .arg((qulonglong)starved);
+            // Frames the pool could not hold reach no task at all, so audio,
+            // detections and mask checks have gaps there
+            if (starved) text += "\nOVERLOAD: audio, detections and mask checks have gaps";
+            for (const auto &t : tasks) {
+                text += QString("\n%1: %2 done, %3 dropped, %4 queued, %5 / %6 ms")
+                            .arg(QString::fromStdString(t.name))
+                            .arg((qulonglong)t.processed)
+                            .arg((qulonglong)t.dropped)
+                            .arg((qulonglong)t.backlog)
+                            .arg(t.avg_latency_ms, 0, 'f', 1)
+                            .arg(t.max_latency_ms, 0, 'f', 1);
+            }
+            tasksLabel->setText(text);
+
+            if (worker->agc_enabled) {
+                agcLabel->setText(QString("AGC: gain %1 dB, level %2 dBFS, %3 steps")
+                                      .arg(worker->rx_gain_now.load(), 0, 'f', 0)
+                                      .arg(worker->agc_level_dbfs.load(), 0, 'f', 1)
+                                      .arg((qulonglong)worker->rx_gain_steps.load()));
+            } else {
+                agcLabel->setText(QString("AGC: off, gain %1 dB").arg(worker->rx_gain_now.load(), 0, 'f', 0));
+            }
+        }
+
+        // Shrinking takes the subsystems' own locks, so it runs here rather
+        // than on the radio thread
+        worker->memory_budget.enforce();
+        size_t budget_total = 0;
+        QString budget_text;
+        for (const auto &u : worker->memory_budget.usage()) {
+            budget_total += u.bytes;
+            budget_text += QString("\n%1: %2 MB%3")
+                               .arg(QString::fromStdString(u.name))
+                               .arg(u.bytes / 1048576.0, 0, 'f', 1)
+                               .arg(u.shrinks ? QString(", shrunk %1x").arg((qulonglong)u.shrinks) : QString());
+        }
+        budgetLabel->setText(QString("Budget: %1 of %2 MB").arg(budget_total / 1048576.0, 0, 'f', 1)
+                                 .arg((qulonglong)(worker->memory_budget.limit() >> 20)) + budget_text);
+
+        WaveformLibrary::Stats ws = worker->waveforms.stats();
+        cacheLabel->setText(QString("Cache: %1 waves, %2 KB\nhits %3, misses %4, evicted %5")
+                                .arg((qulonglong)ws.entries)
+                                .arg((qulonglong)(ws.bytes >> 10))
+                                .arg((qulonglong)ws.hits)
+                                .arg((qulonglong)ws.misses)
+                                .arg((qulonglong)ws.evictions));
+
+        if (worker->isRunning() && worker->relay_mode) {
+            relayLabel->setText(QString("Latency: %1 ms, jitter %2 ms, max %3 ms\n%4, starved %5")
+                                    .arg(worker->relay_latency_ms.load(), 0, 'f', 3)
+                                    .arg(worker->relay_jitter_ms.load(), 0, 'f', 3)
+                                    .arg(worker->relay_max_ms.load(), 0, 'f', 3)
+                                    .arg(worker->relay_pinned ? "pinned" : "not pinned")
+                                    .arg((qulonglong)worker->relay_starved.load()));
+        }
+        if (worker->isRunning()) {
+            double bound = worker->inflight_bound_ms.load();
+            latencyLabel->setText(QString("Control->TX: avg %1 ms, max %2 ms\n%3")
+                                      .arg(worker->control_latency_ms.load(), 0, 'f', 2)
+                                      .arg(worker->control_latency_max_ms.load(), 0, 'f', 2)
+                                      .arg(bound < 0 ? QString("In flight: unbounded (transport default)")
+                                                     : QString("In flight: <= %1 ms").arg(bound, 0, 'f', 2)));
+        }
+        if (fmBtn->isChecked() && !worker->fm_enabled) fmBtn->setChecked(false); // Output failed to open
+        iqCalBtn->setEnabled(worker->isRunning() && !worker->iq_calibrating);
+        if (iqCorrectCheck->isChecked() != worker->iq_correct) iqCorrectCheck->setChecked(worker->iq_correct);
+        if (worker->iq_calibrating) {
+            iqLabel->setText("Calibrating...");
+        } else if (!std::isnan(worker->iq_irr_before_db.load())) {
+            double after = worker->iq_irr_after_db.load();
+            iqLabel->setText(std::isnan(after)
+                                 ? QString("Calibration failed (no loopback?)")
+                                 : QString("Image rejection: %1 -> %2 dB\nCarrier leakage: %3 -> %4 dBc")
+                                       .arg(worker->iq_irr_before_db.load(), 0, 'f', 1)
+                                       .arg(after, 0, 'f', 1)
+                                       .arg(worker->iq_leak_before_dbc.load(), 0, 'f', 1)
+                                       .arg(worker->iq_leak_after_dbc.load(), 0, 'f', 1));
+        }
+        if (worker->zoom_enabled && frozen.frames.empty()) { // While frozen it shows zoomFrozen()'s
+            double rbw = worker->zoom_rbw.load();
+            double full_fft = rbw > 0 ? 1e6 / rbw : 0; // Same resolution at the full 1 MS/s
+            zoomLabel->setText(QString("RBW: %1 Hz (a %2M-point FFT at full rate)\nSpectra: %3, %4% of a core")
+                                   .arg(rbw, 0, 'f', 3)
+                                   .arg(full_fft / 1048576.0, 0, 'f', 1)
+                                   .arg((qulonglong)worker->zoom_spectra.load())
+                                   .arg(worker->zoom_load.load() * 100.0, 0, 'f', 1));
+        }
+        if (worker->dpd_enabled) {
+            uint64_t fits = worker->dpd_fits.load();
+            dpdLabel->setText(fits ? QString("Fits: %1, loop error %2 dB")
+                                         .arg((qulonglong)fits)
+                                         .arg(worker->dpd_error_db.load(), 0, 'f', 1)
+                                   : QString("Model: identity (waiting for a loopback capture)"));
+        }
+        if (worker->mask_invalid && maskBtn->isChecked()) {
+            maskBtn->setChecked(false);
+            maskLabel->setText("Mask: could not parse (use offset_kHz:limit_dB, ...)");
+        } else if (worker->mask_enabled) {
+            uint64_t failed = worker->mask_failed.load();
+            double first = worker->mask_first_fail_s.load();
+            maskLabel->setText(QString("%1: %2 of %3 frames failed, %4 bins\nWorst margin %5 dB%6")
+                                   .arg(failed ? "FAIL" : "PASS")
+                                   .arg((qulonglong)failed)
+                                   .arg((qulonglong)worker->mask_frames.load())
+                                   .arg((qulonglong)worker->mask_violations.load())
+                                   .arg(worker->mask_worst_db.load(), 0, 'f', 1)
+                                   .arg(first < 0 ? QString() : QString(", first at %1 s").arg(first, 0, 'f', 3)));
+            maskLabel->setStyleSheet(failed ? "color: #FF5252;" : "color: #69F0AE;");
+        }
+        if (worker->fm_enabled) {
+            fmLabel->setText(QString("Audio: %1 s  (%2% of a core)")
+                                 .arg(worker->fm_seconds.load(), 0, 'f', 1)
+                                 .arg(worker->fm_load.load() * 100.0, 0, 'f', 1));
+        }
+        if (worker->channel_record_failed) {
+            chanRecordLabel->setText("Recording: could not create the channel files");
+        } else if (worker->channel_recording) {
+            chanRecordLabel->setText(QString("Recording: %1 channels, %2 s each")
+                                         .arg(worker->channel_count.load())
+                                         .arg(worker->channel_record_seconds.load(), 0, 'f', 1));
+        } else {
+            chanRecordLabel->setText(worker->channel_record ? "Recording: waiting for the channelizer" : "Recording: off");
+        }
+        if (worker->capture_active) {
+            worker->data_mutex.lock();
+            QString last = worker->capture_last_file;
+            worker->data_mutex.unlock();
+            captureLabel->setText(QString("Triggers: %1  Recordings: %2%3%4\nLast: %5")
+                                      .arg((qulonglong)worker->capture_triggers.load())
+                                      .arg((qulonglong)worker->capture_recordings.load())
+                                      .arg(worker->capture_overruns ? QString("  (%1 incomplete)").arg((qulonglong)worker->capture_overruns.load()) : "")
+                                      .arg(worker->capture_writing ? "  WRITING" : "")
+                                      .arg(last.isEmpty() ? "--" : last));
+        }
+    }
+
+    // A sweep can be far wider than the plot, so each column keeps its peak
+    // to stay honest about narrow signals.
+    void updatePanorama(const std::vector<float> &trace, double start_hz, double stop_hz) {
+        if (trace.empty()) return;
+
+        double hz_per_bin = (stop_hz - start_hz) / trace.size();
+        BinReducer::reduce(trace.data(), 0, trace.size(), std::max(200, panoView->width()),
+                           BinReducer::Peak, reducedPos, reducedVal);
+        QList<QPointF> pP;
+        for (size_t i = 0; i < reducedVal.size(); i++) {
+            pP.append(QPointF((start_hz + reducedPos[i] * hz_per_bin) / 1e6, reducedVal[i]));
+        }
+        panoSeries->replace(pP);
+        qobject_cast<QValueAxis*>(panoChart->axes(Qt::Horizontal).first())->setRange(start_hz / 1e6, stop_hz / 1e6);
+
+        panoLabel->setText(QString("Sweep: %1 s/GHz").arg(worker->pano_sec_per_ghz.load(), 0, 'f', 2));
+    }
+
+    // Only the part of the span the decimation filter passes cleanly is shown
+    void updateZoom(const std::vector<float> &psd_db, double span_hz) {
+        if (psd_db.empty()) return;
+        double usable = 0.8 * span_hz;
+        double hz_per_bin = span_hz / psd_db.size();
+        size_t first = size_t((span_hz - usable) / 2 / hz_per_bin);
+        size_t last = psd_db.size() - first;
+        BinReducer::reduce(psd_db.data(), first, last, std::max(200, zoomView->width()),
+                           BinReducer::Peak, reducedPos, reducedVal);
+        QList<QPointF> pZ;
+        for (size_t i = 0; i < reducedVal.size(); i++) {
+            pZ.append(QPointF(-span_hz / 2 + reducedPos[i] * hz_per_bin, reducedVal[i]));
+        }
+        zoomSeries->replace(pZ);
+        qobject_cast<QValueAxis*>(zoomChart->axes(Qt::Horizontal).first())->setRange(-usable / 2, usable / 2);
+    }
+
+    // Runs the database query from the search controls and lists the hits
+    void searchEvents() {
+        const size_t max_listed = 1000;
+        EventStore::Query q;
+        double first = eventStore.firstTime();
+        q.t0 = first + dbFromBox->value() * 3600.0;
+        q.t1 = first + dbToBox->value() * 3600.0;
+        q.lo_hz = dbLoBox->value() * 1e6;
+        q.hi_hz = dbHiBox->value() * 1e6;
+        q.kind = dbKindCombo->currentIndex() - 1;
+        q.limit = max_listed + 1;
+
+        searchHits.clear();
+        EventStore::QueryStats stats;
+        QElapsedTimer t;
+        t.start();
+        eventStore.query(q, searchHits, &stats);
+        double ms = t.nsecsElapsed() / 1e6;
+        bool more = searchHits.size() > max_listed;
+        if (more) searchHits.resize(max_listed);
+
+        dbResultList->clear();
+        for (const auto &e : searchHits) {
+            QString where = e.hi_hz > e.lo_hz ? QString("%1-%2 MHz").arg(e.lo_hz / 1e6, 0, 'f', 4).arg(e.hi_hz / 1e6, 0, 'f', 4)
+                                              : QString("%1 MHz").arg(e.lo_hz / 1e6, 0, 'f', 4);
+            QString what = e.kind == StoredEvent::Preamble ? QString("preamble %1").arg(e.level, 0, 'f', 2)
+                                                           : QString("%1 dBFS").arg(e.level, 0, 'f', 1);
+            dbResultList->addItem(QString("+%1 h  %2  %3").arg((e.time_s - first) / 3600.0, 0, 'f', 4).arg(where).arg(what));
+        }
+        dbLabel->setText(QString("%1%2 hits in %3 ms  (%4 of %5 blocks read, %6 events stored)")
+                             .arg(searchHits.size())
+                             .arg(more ? "+" : "")
+                             .arg(ms, 0, 'f', 2)
+                             .arg(stats.blocks_read)
+                             .arg(stats.blocks)
+                             .arg((qulonglong)eventStore.size()));
+    }
+
+    // Brings a search hit into view: the spectrum zooms to it when it is in
+    // the current span, and the capture recording holding it is named
+    void showHit(const StoredEvent &e) {
+        double rx = worker->frequency.load();
+        double lo_khz = (e.lo_hz - rx) / 1e3, hi_khz = (e.hi_hz - rx) / 1e3;
+        QString text;
+        if (lo_khz >= -500 && hi_khz <= 500) {
+            double margin = std::max(5.0, hi_khz - lo_khz);
+            QValueAxis *x = qobject_cast<QValueAxis*>(specChart->axes(Qt::Horizontal).first());
+            x->setRange(std::max(-500.0, lo_khz - margin), std::min(500.0, hi_khz + margin));
+        } else {
+            text = "Outside the current span. ";
+        }
+        std::string file;
+        uint64_t sample = 0;
+        if (CaptureRing::locate(".", e.time_s, file, sample)) {
+            text += QString("Recorded in %1 at sample %2").arg(QString::fromStdString(file)).arg((qulonglong)sample);
+        } else {
+            text += "No capture recording holds this event";
+        }
+        dbLabel->setText(text);
+    }
+
+    // Pulls detections from the worker, writes them to the CSV log and
+    // keeps the most recent ones visible in the panel.
+    void drainEvents() {
+        std::vector<DetectionEvent> events;
+        std::vector<PreambleDetection> preambles;
+        worker->event_mutex.lock();
+        events.swap(worker->pending_events);
+        preambles.swap(worker->pending_preambles);
+        worker->event_mutex.unlock();
+
+        // Detections are timed in stream seconds; the database keeps Unix time
+        double epoch = worker->stream_epoch_s.load();
+        for (const auto &ev : events) {
+            eventStore.append({epoch + ev.time_s, ev.start_hz, ev.stop_hz, ev.peak_db, ev.noise_floor_db, StoredEvent::Energy});
+        }
+        for (const auto &d : preambles) {
+            double hz = d.center_hz + d.freq_offset_hz;
+            eventStore.append({epoch + d.time_s, hz, hz, d.peak, 0.0f, StoredEvent::Preamble});
+        }
+        if (eventSyncTimer.elapsed() > 1000) {
+            eventStore.sync();
+            eventSyncTimer.start();
+        }
+
+        if (!preambles.empty()) {
+            preambleCount += preambles.size();
+            const auto &d = preambles.back();
+            corrLabel->setText(QString("Detections: %1\nLast: t=%2 s  idx %3%4\nCFO %5 Hz  peak %6")
+                                   .arg((qulonglong)preambleCount)
+                                   .arg(d.time_s, 0, 'f', 6)
+                                   .arg((qulonglong)d.sample_index)
+                                   .arg(d.timing_offset >= 0 ? QString("+%1").arg(d.timing_offset, 0, 'f', 2)
+                                                             : QString::number(d.timing_offset, 'f', 2))
+                                   .arg(d.freq_offset_hz, 0, 'f', 0)
+                                   .arg(d.peak, 0, 'f', 2));
+        }
+
+        if (worker->detector_enabled) {
+            floorLabel->setText(QString("Noise Floor: %1 dBFS  (dropped %2)")
+                                    .arg(worker->noise_floor_db.load(), 0, 'f', 1)
+                                    .arg((qulonglong)worker->dropped_events.load()));
+        }
+        if (events.empty()) return;
+
+        for (const auto &ev : events) {
+            eventLog << ev.time_s << "," << ev.start_hz << "," << ev.stop_hz << ","
+                     << ev.peak_db << "," << ev.noise_floor_db << "," << ev.rx_gain_db << "\n";
+        }
+        eventLog.flush();
+
+        // Only the tail is worth rendering at full frame rate
+        size_t first = events.size() > 20 ? events.size() - 20 : 0;
+        for (size_t i = first; i < events.size(); i++) {
+            const auto &ev = events[i];
+            eventList->addItem(QString("%1 s  %2-%3 MHz  %4 dBFS")
+                                   .arg(ev.time_s, 0, 'f', 3)
+                                   .arg(ev.start_hz / 1e6, 0, 'f', 4)
+                                   .arg(ev.stop_hz / 1e6, 0, 'f', 4)
+                                   .arg(ev.peak_db, 0, 'f', 1));
+        }
+        while (eventList->count() > 100) delete eventList->takeItem(0);
+        eventList->scrollToBottom();
+    }
+};
+
+// --- 4. COMMAND LINE BENCHMARKS ---
+
+volatile float bench_sink;
+
+// Channelizer throughput against channel count, in input MS/s on one core
+void benchChannelizer() {
+    const size_t n = 1 << 20;
+    std::vector<std::complex<float>> input(n);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> gauss;
+    for (auto &s : input) s = std::complex<float>(gauss(rng), gauss(rng));
+
+    printf("%8s %14s %14s\n", "M", "1x (MS/s)", "2x (MS/s)");
+    for (size_t m : {8, 16, 32, 64, 128, 256, 512, 1024}) {
+        double rates[2];
+        for (size_t os = 1; os <= 2; os++) {
+            PolyphaseChannelizer pc;
+            pc.configure(m, os);
+            std::vector<std::vector<std::complex<float>>> out;
+            QElapsedTimer t;
+            t.start();
+            pc.process(input.data(), input.size(), out);
+            rates[os - 1] = n / (t.nsecsElapsed() * 1e-9) / 1e6;
+        }
+        printf("%8zu %14.1f %14.1f\n", m, rates[0], rates[1]);
+    }
+}
+
+// Sequential and random access over a 512 MB sample buffer in each page
+// mode. Random reads touch a new page almost every time, so they expose
+// TLB reach; streaming shows the cost (or not) of the bigger pages.
+void benchHugePages() {
+    const size_t bytes = 512u << 20;
+    const size_t n = bytes / sizeof(std::complex<float>);
+    const size_t random_reads = 1 << 24;
+    const char *names[] = {"4K pages", "THP", "Explicit"};
+
+    printf("%-10s %-10s %12s %18s\n", "Requested", "Got", "Seq (GB/s)", "Random (ns/read)");
+    for (int m = HugePages::Normal; m <= HugePages::Explicit; m++) {
+        auto *buf = static_cast<std::complex<float> *>(HugePages::map(bytes, HugePages::Mode(m)));
+        HugePages::Mode got = HugePages::modeOf(buf);
+        for (size_t i = 0; i < n; i++) buf[i] = std::complex<float>(i & 0xff, 0); // Fault everything in
+
+        QElapsedTimer t;
+        t.start();
+        float acc = 0;
+        for (int pass = 0; pass < 4; pass++)
+            for (size_t i = 0; i < n; i++) acc += buf[i].real();
+        double seq = 4.0 * bytes / (t.nsecsElapsed() * 1e-9) / 1e9;
+
+        uint64_t x = 88172645463325252ull;
+        t.start();
+        for (size_t i = 0; i < random_reads; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            acc += buf[x % n].real();
+        }
+        double rnd = t.nsecsElapsed() / double(random_reads);
+
+        bench_sink = acc; // Keep the reads from being optimized away
+
+        printf("%-10s %-10s %12.2f %18.1f\n", names[m], names[got], seq, rnd);
+        HugePages::unmap(buf, bytes);
+    }
+}
+
+// The FM front end's kernels on interleaved std::complex data and on split
+// I/Q, in ns per input sample on one core, plus the cost of converting
+// between the two layouts
+void benchPlanar() {
+    const size_t n = 1 << 20;
+    const int passes = 8;
+    std::vector<std::complex<float>> input(n), mixed(n);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> gauss;
+    for (auto &s : input) s = std::complex<float>(gauss(rng), gauss(rng));
+    PlanarSamples split, split_out;
+    split.resize(n);
+    split_out.resize(n);
+    deinterleave(input.data(), n, split.i.data(), split.q.data());
+    std::vector<float> out(n);
+
+    auto time = [&](const std::function<void()> &kernel) {
+        QElapsedTimer t;
+        t.start();
+        for (int p = 0; p < passes; p++) kernel();
+        return t.nsecsElapsed() / double(passes) / n;
+    };
+    auto row = [](const char *name, double inter, double planar) {
+        printf("%-22s %16.2f %12.2f %8.1fx\n", name, inter, planar, inter / planar);
+    };
+    const std::complex<float> step = std::polar(1.0f, 0.01f);
+
+    printf("%-22s %16s %12s %9s\n", "Kernel", "Interleaved (ns)", "Planar (ns)", "Gain");
+    double to_split = time([&] { deinterleave(input.data(), n, split.i.data(), split.q.data()); });
+    double to_inter = time([&] { interleave(split.i.data(), split.q.data(), n, mixed.data()); });
+    printf("%-22s %16.2f %12.2f\n", "Convert (to/from)", to_inter, to_split);
+
+    double mix_c = time([&] {
+        std::complex<float> rot = 1.0f;
+        for (size_t i = 0; i < n; i++) {
+            mixed[i] = input[i] * rot;
+            rot *= step;
+        }
+    });
+    double mix_p = time([&] {
+        float lane_r[8], lane_i[8];
+        std::complex<float> p = 1.0f;
+        for (size_t l = 0; l < 8; l++, p *= step) {
+            lane_r[l] = p.real();
+            lane_i[l] = p.imag();
+        }
+        std::complex<float> step8 = std::pow(step, 8);
+        for (size_t k = 0; k + 8 <= n; k += 8) {
+            for (size_t l = 0; l < 8; l++) {
+                float x = split.i[k + l], y = split.q[k + l];
+                split_out.i[k + l] = x * lane_r[l] - y * lane_i[l];
+                split_out.q[k + l] = x * lane_i[l] + y * lane_r[l];
+                float r = lane_r[l] * step8.real() - lane_i[l] * step8.imag();
+                lane_i[l] = lane_r[l] * step8.imag() + lane_i[l] * step8.real();
+                lane_r[l] = r;
+            }
+        }
+    });
+    row("NCO mix", mix_c, mix_p);
+
+    FirDecimator<std::complex<float>> fir_c;
+    PlanarFirDecimator fir_p;
+    fir_c.configure(4, 33, 0.1);
+    fir_p.configure(4, 33, 0.1);
+    double fir_c_ns = time([&] {
+        mixed.clear();
+        fir_c.process(input.data(), n, mixed);
+    });
+    double fir_p_ns = time([&] {
+        split_out.clear();
+        fir_p.process(split.i.data(), split.q.data(), n, split_out);
+    });
+    row("FIR 33 taps, 4:1", fir_c_ns, fir_p_ns);
+
+    double disc_c = time([&] {
+        const float *b = reinterpret_cast<const float *>(input.data());
+        for (size_t i = 1; i < n; i++) {
+            float re = b[2 * i] * b[2 * i - 2] + b[2 * i + 1] * b[2 * i - 1];
+            float im = b[2 * i + 1] * b[2 * i - 2] - b[2 * i] * b[2 * i - 1];
+            out[i] = fastAtan2(im, re);
+        }
+    });
+    double disc_p = time([&] {
+        const float *bi = split.i.data(), *bq = split.q.data();
+        for (size_t i = 1; i < n; i++) {
+            float re = bi[i] * bi[i - 1] + bq[i] * bq[i - 1];
+            float im = bq[i] * bi[i - 1] - bi[i] * bq[i - 1];
+            out[i] = fastAtan2(im, re);
+        }
+    });
+    row("FM discriminator", disc_c, disc_p);
+
+    double pow_c = time([&] {
+        for (size_t i = 0; i < n; i++) out[i] = std::norm(input[i]);
+    });
+    double pow_p = time([&] {
+        for (size_t i = 0; i < n; i++) out[i] = split.i[i] * split.i[i] + split.q[i] * split.q[i];
+    });
+    row("Power |x|^2", pow_c, pow_p);
+    bench_sink = out[n / 2] + split_out.i[0] + mixed[0].real();
+}
+
+// Event database: ten million events over ten hours, then the queries the
+// search panel issues. Uses a scratch file in /tmp.
+void benchEventStore() {
+    const char *path = "/tmp/usrp_viz_bench.evdb";
+    const size_t n = 10000000;
+    const double start = 1.7e9, span = 10 * 3600.0;
+    unlink(path);
+
+    EventStore db;
+    if (!db.open(path)) {
+        printf("cannot create %s\n", path);
+        return;
+    }
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> freq(880e6, 950e6);
+    QElapsedTimer t;
+    t.start();
+    for (size_t i = 0; i < n; i++) {
+        double f = freq(rng);
+        db.append({start + span * i / n, f, f + 20e3, -40.0f, -90.0f, uint8_t(i % 10 == 0)});
+    }
+    db.sync();
+    printf("append: %.1f M events/s\n", n / (t.nsecsElapsed() * 1e-9) / 1e6);
+
+    struct Case { const char *name; double lo_mhz, hi_mhz; int kind; };
+    const Case cases[] = {
+        {"902-928 MHz, hour 3", 902, 928, -1},
+        {"915-915.1 MHz, hour 3", 915, 915.1, -1},
+        {"preambles 915-915.1 MHz, hour 3", 915, 915.1, StoredEvent::Preamble},
+        {"960-970 MHz (none)", 960, 970, -1},
+    };
+    printf("%-34s %10s %10s %14s\n", "Query", "Hits", "ms", "Blocks read");
+    for (const Case &c : cases) {
+        EventStore::Query q;
+        q.t0 = start + 3 * 3600.0;
+        q.t1 = start + 4 * 3600.0;
+        q.lo_hz = c.lo_mhz * 1e6;
+        q.hi_hz = c.hi_mhz * 1e6;
+        q.kind = c.kind;
+        std::vector<StoredEvent> hits;
+        EventStore::QueryStats stats;
+        t.start();
+        db.query(q, hits, &stats);
+        printf("%-34s %10zu %10.2f %8zu/%zu\n", c.name, hits.size(), t.nsecsElapsed() / 1e6, stats.blocks_read, stats.blocks);
+    }
+    db.close();
+    unlink(path);
+}
+
+// --- OFFLINE BATCH ANALYSIS ---
+// usrp_viz --batch [--rate HZ] [--fft N] [--threshold DB] [--threads N]
+//                  [--csv PATH] [--json PATH] FILE...
+// Runs the live PSD, CCDF and energy detector over capture files. Inputs
+// are SigMF recordings (cf32_le) or raw fc32 at --rate. Files are mmap'ed
+// and cut into frame-aligned jobs, so one large file spreads over every
+// core as well as many small ones. Each file's results are written as soon
+// as its last job is done: a summary row to the CSV, and the PSD, CCDF
+// curve and detections as one JSON line.
+
+struct BatchFile {
+    std::string path;
+    const std::complex<float> *samples = nullptr;
+    size_t count = 0;
+    double rate = 1e6;
+    double center_hz = 0;
+    size_t map_bytes = 0;
+
+    // Merged job results
+    std::mutex mutex;
+    size_t jobs_left = 0;
+    std::vector<double> psd_sum;
+    uint64_t frames = 0;
+    PowerStats power;
+    std::vector<DetectionEvent> detections;
+};
+
+struct BatchJob {
+    BatchFile *file;
+    size_t first, count; // Samples
+};
+
+static bool openBatchFile(BatchFile &f, double default_rate, std::string &error) {
+    std::string data = f.path;
+    const std::string meta_ext = ".sigmf-meta", data_ext = ".sigmf-data";
+    auto endsWith = [](const std::string &s, const std::string &e) {
+        return s.size() >= e.size() && s.compare(s.size() - e.size(), e.size(), e) == 0;
+    };
+    if (endsWith(data, meta_ext)) data.replace(data.size() - meta_ext.size(), meta_ext.size(), data_ext);
+    f.rate = default_rate;
+    if (endsWith(data, data_ext)) {
+        std::ifstream meta(data.substr(0, data.size() - data_ext.size()) + meta_ext);
+        std::stringstream text;
+        text << meta.rdbuf();
+        std::string json = text.str();
+        std::string type = sigmfField(json, "core:datatype");
+        if (!type.empty() && type != "cf32_le") {
+            error = "unsupported datatype " + type;
+            return false;
+        }
+        if (double rate = atof(sigmfField(json, "core:sample_rate").c_str())) f.rate = rate;
+        f.center_hz = atof(sigmfField(json, "core:frequency").c_str());
+    }
+    f.path = data;
+
+    int fd = ::open(data.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) ::close(fd);
+        error = strerror(errno);
+        return false;
+    }
+    f.map_bytes = st.st_size;
+    f.count = f.map_bytes / sizeof(std::complex<float>);
+    if (f.count) {
+        void *p = mmap(nullptr, f.map_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            error = strerror(errno);
+            return false;
+        }
+        madvise(p, f.map_bytes, MADV_SEQUENTIAL);
+        f.samples = static_cast<const std::complex<float> *>(p);
+    }
+    ::close(fd);
+    return true;
+}
+
+static std::string jsonQuote(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Writes each finished file's results; called from the worker threads
+class BatchOutput {
+public:
+    bool open(const std::string &csv_path, const std::string &json_path) {
+        if (!csv_path.empty()) {
+            csv.open(csv_path);
+            if (!csv) return false;
+            csv << "file,samples,seconds,sample_rate,center_hz,mean_dbfs,peak_dbfs,papr_db,"
+                   "ccdf_1pct_db,ccdf_0.1pct_db,ccdf_0.01pct_db,detections\n";
+        }
+        if (!json_path.empty()) {
+            json.open(json_path);
+            if (!json) return false;
+        }
+        return true;
+    }
+
+    void write(const BatchFile &f, size_t fft_size) {
+        const size_t max_listed = 10000;
+        double mean = f.power.meanPower();
+        double mean_db = 10.0 * log10(mean + 1e-30), peak_db = 10.0 * log10(f.power.peakPower() + 1e-30);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (csv.is_open()) {
+            csv << f.path << "," << f.count << "," << f.count / f.rate << "," << f.rate << "," << f.center_hz << ","
+                << mean_db << "," << peak_db << "," << peak_db - mean_db << "," << f.power.levelAt(1e-2) << ","
+                << f.power.levelAt(1e-3) << "," << f.power.levelAt(1e-4) << "," << f.detections.size() << "\n";
+            csv.flush();
+        }
+        if (json.is_open()) {
+            json << "{\"file\": " << jsonQuote(f.path) << ", \"samples\": " << f.count << ", \"sample_rate\": " << f.rate
+                 << ", \"center_hz\": " << f.center_hz << ", \"mean_dbfs\": " << mean_db << ", \"peak_dbfs\": " << peak_db
+                 << ", \"ccdf\": [";
+            for (int i = 0; i <= 24; i++) json << (i ? ", " : "") << "[" << i * 0.5 << ", " << f.power.ccdf(i * 0.5) << "]";
+            json << "], \"fft_size\": " << fft_size << ", \"psd_dbfs\": [";
+            for (size_t k = 0; k < f.psd_sum.size(); k++)
+                json << (k ? ", " : "") << 10.0 * log10(f.psd_sum[k] / std::max<uint64_t>(f.frames, 1) + 1e-20);
+            json << "], \"detections_total\": " << f.detections.size() << ", \"detections\": [";
+            for (size_t i = 0; i < std::min(f.detections.size(), max_listed); i++) {
+                const DetectionEvent &d = f.detections[i];
+                json << (i ? ", " : "") << "{\"time_s\": " << d.time_s << ", \"start_hz\": " << d.start_hz
+                     << ", \"stop_hz\": " << d.stop_hz << ", \"peak_dbfs\": " << d.peak_db << "}";
+            }
+            json << "]}\n";
+            json.flush();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::ofstream csv, json;
 };
 
+int runBatch(int argc, char *argv[]) {
+    double rate = 1e6, threshold = 10.0;
+    size_t fft_size = 2048, threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csv_path, json_path;
+    std::vector<std::unique_ptr<BatchFile>> files;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--rate" && has_value) rate = atof(argv[++i]);
+        else if (arg == "--fft" && has_value) fft_size = atoi(argv[++i]);
+        else if (arg == "--threshold" && has_value) threshold = atof(argv[++i]);
+        else if (arg == "--threads" && has_value) threads = std::max(1, atoi(argv[++i]));
+        else if (arg == "--csv" && has_value) csv_path = argv[++i];
+        else if (arg == "--json" && has_value) json_path = argv[++i];
+        else if (arg == "--no-hugepages") continue;
+        else {
+            files.push_back(std::make_unique<BatchFile>());
+            files.back()->path = arg;
+        }
+    }
+    if (files.empty() || fft_size < 16 || (fft_size & (fft_size - 1))) {
+        printf("usage: usrp_viz --batch [--rate HZ] [--fft N] [--threshold DB] [--threads N]\n"
+               "                        [--csv PATH] [--json PATH] FILE...\n");
+        return 1;
+    }
+    if (csv_path.empty() && json_path.empty()) csv_path = "batch_results.csv";
+    BatchOutput output;
+    if (!output.open(csv_path, json_path)) {
+        printf("cannot write results\n");
+        return 1;
+    }
+
+    // Jobs are whole frames; a file's last job also takes its partial frame
+    const size_t job_samples = std::max<size_t>(1, (4u << 20) / fft_size) * fft_size;
+    std::vector<BatchJob> jobs;
+    std::vector<BatchFile *> opened;
+    uint64_t total_bytes = 0;
+    for (auto &f : files) {
+        std::string error;
+        if (!openBatchFile(*f, rate, error)) {
+            printf("%s: %s\n", f->path.c_str(), error.c_str());
+            continue;
+        }
+        f->psd_sum.assign(fft_size, 0.0);
+        size_t first = 0;
+        do {
+            size_t n = f->count - first <= job_samples + fft_size ? f->count - first : job_samples;
+            jobs.push_back({f.get(), first, n});
+            f->jobs_left++;
+            first += n;
+        } while (first < f->count);
+        total_bytes += f->map_bytes;
+        opened.push_back(f.get());
+    }
+
+    std::atomic<size_t> next_job{0};
+    auto worker = [&]() {
+        SpectrumAnalyzer analyzer;
+        analyzer.configure(fft_size);
+        EnergyDetector detector;
+        detector.threshold_db = threshold;
+        std::vector<float> power, psd_db;
+        std::vector<double> psd_sum(fft_size);
+        std::vector<DetectionEvent> detections;
+        for (size_t j; (j = next_job++) < jobs.size();) {
+            const BatchJob &job = jobs[j];
+            BatchFile &f = *job.file;
+            const std::complex<float> *x = f.samples + job.first;
+
+            PowerStats stats;
+            stats.add(x, job.count);
+            std::fill(psd_sum.begin(), psd_sum.end(), 0.0);
+            detections.clear();
+            size_t frames = job.count / fft_size;
+            for (size_t k = 0; k < frames; k++) {
+                analyzer.power(x + k * fft_size, power);
+                psd_db.resize(fft_size);
+                for (size_t b = 0; b < fft_size; b++) {
+                    psd_sum[b] += power[b];
+                    psd_db[b] = 10.0f * log10f(power[b] + 1e-20f);
+                }
+                double time_s = (job.first + k * fft_size) / f.rate;
+                detector.process(psd_db, f.center_hz, f.rate, time_s, detections);
+            }
+
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(f.mutex);
+                for (size_t b = 0; b < fft_size; b++) f.psd_sum[b] += psd_sum[b];
+                f.frames += frames;
+                f.power.merge(stats);
+                f.detections.insert(f.detections.end(), detections.begin(), detections.end());
+                last = --f.jobs_left == 0;
+            }
+            if (last) {
+                std::sort(f.detections.begin(), f.detections.end(),
+                          [](const DetectionEvent &a, const DetectionEvent &b) { return a.time_s < b.time_s; });
+                output.write(f, fft_size);
+                if (f.samples) munmap(const_cast<std::complex<float> *>(f.samples), f.map_bytes);
+                f.samples = nullptr;
+            }
+        }
+    };
+
+    QElapsedTimer t;
+    t.start();
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < threads; i++) pool.emplace_back(worker);
+    for (auto &th : pool) th.join();
+    double secs = t.nsecsElapsed() * 1e-9;
+
+    printf("%zu files, %zu jobs, %.2f GB in %.2f s on %zu threads: %.2f GB/s\n", opened.size(), jobs.size(),
+           total_bytes / 1e9, secs, threads, total_bytes / 1e9 / secs);
+    return opened.size() == files.size() ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--no-hugepages") HugePages::enabled = false;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-channelizer") {
+        benchChannelizer();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-hugepages") {
+        benchHugePages();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-planar") {
+        benchPlanar();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-eventdb") {
+        benchEventStore();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--batch") return runBatch(argc - 2, argv + 2);
+
     QApplication a(argc, argv);
     MainWindow w;
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        w.startHeadless();
+        return a.exec();
+    }
     w.show();
+    if (argc > 1 && std::string(argv[1]) == "--startup-time") w.measureStartup();
     return a.exec();
 }
\ No newline at end of file
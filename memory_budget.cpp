@@ -0,0 +1,65 @@
+#include "memory_budget.h"
+
+#include <algorithm>
+
+std::unique_ptr<MemoryBudget::Registration> MemoryBudget::add(const std::string &name, int priority, UsageFn usage, ShrinkFn shrink,
+                                                              GrowFn grow) {
+    auto e = std::make_shared<Entry>();
+    e->name = name;
+    e->priority = priority;
+    e->usage = std::move(usage);
+    e->shrink = std::move(shrink);
+    e->grow = std::move(grow);
+    std::lock_guard<std::mutex> lock(mutex);
+    e->id = next_id++;
+    auto pos = std::upper_bound(entries.begin(), entries.end(), priority,
+                                [](int p, const std::shared_ptr<Entry> &x) { return p < x->priority; });
+    entries.insert(pos, std::move(e));
+    return std::make_unique<Registration>(this, next_id - 1);
+}
+
+size_t MemoryBudget::enforce() {
+    std::vector<std::shared_ptr<Entry>> list = snapshot();
+    size_t total = 0;
+    for (const auto &e : list) total += e->call([&] { return e->usage(); });
+    size_t limit = limit_bytes, freed = 0;
+    size_t margin = limit / 8;
+    for (auto it = list.rbegin(); it != list.rend() && total + margin < limit; ++it) {
+        const auto &e = *it;
+        if (!e->grow) continue;
+        size_t headroom = limit - margin - total;
+        total += std::min(e->call([&] { return e->grow(headroom); }), headroom);
+    }
+    for (auto &e : list) {
+        if (total <= limit) break;
+        if (!e->shrink) continue;
+        size_t excess = total - limit;
+        size_t got = std::min(e->call([&] { return e->shrink(excess); }), total);
+        if (got > 0) e->shrinks++;
+        total -= got;
+        freed += got;
+    }
+    return freed;
+}
+
+std::vector<MemoryBudget::Usage> MemoryBudget::usage() const {
+    std::vector<Usage> out;
+    for (const auto &e : snapshot()) {
+        size_t bytes = e->call([&] { return e->usage(); });
+        out.push_back({e->name, e->priority, bytes, e->shrinks.load()});
+    }
+    return out;
+}
+
+void MemoryBudget::remove(int id) {
+    std::shared_ptr<Entry> gone;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(entries.begin(), entries.end(), [id](const std::shared_ptr<Entry> &e) { return e->id == id; });
+        if (it == entries.end()) return;
+        gone = *it;
+        entries.erase(it);
+    }
+    std::lock_guard<std::mutex> lock(gone->call_mutex);
+    gone->alive = false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One memory limit shared by every subsystem whose size is elastic. Each
+// registers a usage probe and, if it can give memory back, a shrink hook.
+// When the total is over the limit the hooks are called lowest priority
+// first until it fits; subsystems without a hook are only counted. A
+// subsystem that stays small once shrunk can also register a grow hook,
+// called highest priority first once there is room again. Probes
+// and hooks run on whichever thread calls usage() or enforce(), so they must
+// be safe to call from outside their subsystem. They run without the
+// budget's own lock, so a hook may take its subsystem's locks while that
+// subsystem registers elsewhere; only destroying a Registration waits for a
+// running hook, so don't do that while holding a lock the hook takes.
+class MemoryBudget {
+public:
+    using UsageFn = std::function<size_t()>;
+    using ShrinkFn = std::function<size_t(size_t excess)>; // Returns bytes freed
+    using GrowFn = std::function<size_t(size_t headroom)>; // Returns bytes taken back
+
+    struct Usage {
+        std::string name;
+        int priority;
+        size_t bytes;
+        uint64_t shrinks;
+    };
+
+    // Removes its entry when destroyed, so a subsystem can't outlive it
+    class Registration {
+    public:
+        Registration(MemoryBudget *budget, int id) : budget(budget), id(id) {}
+        Registration(const Registration &) = delete;
+        Registration &operator=(const Registration &) = delete;
+        ~Registration() { budget->remove(id); }
+
+    private:
+        MemoryBudget *budget;
+        int id;
+    };
+
+    explicit MemoryBudget(size_t limit_bytes) : limit_bytes(limit_bytes) {}
+
+    std::unique_ptr<Registration> add(const std::string &name, int priority, UsageFn usage, ShrinkFn shrink = nullptr,
+                                      GrowFn grow = nullptr);
+
+    void setLimit(size_t bytes) { limit_bytes = bytes; }
+    size_t limit() const { return limit_bytes; }
+
+    // Shrinks subsystems until the total fits; returns bytes freed. Below
+    // the limit, less a margin so it doesn't flap, shrunk subsystems get
+    // their memory back instead.
+    size_t enforce();
+
+    // In shrink order
+    std::vector<Usage> usage() const;
+
+private:
+    struct Entry {
+        int id = 0;
+        std::string name;
+        int priority = 0;
+        UsageFn usage;
+        ShrinkFn shrink;
+        GrowFn grow;
+        std::atomic<uint64_t> shrinks{0};
+        std::mutex call_mutex; // Held while a probe or hook runs
+        bool alive = true;     // Guarded by call_mutex
+
+        // 0 once the entry has been removed
+        template <typename Fn>
+        size_t call(Fn fn) {
+            std::lock_guard<std::mutex> lock(call_mutex);
+            return alive ? fn() : 0;
+        }
+    };
+
+    mutable std::mutex mutex; // Guards the list only, never held across a call
+    std::vector<std::shared_ptr<Entry>> entries; // Sorted by priority
+    std::atomic<size_t> limit_bytes;
+    int next_id = 0;
+
+    std::vector<std::shared_ptr<Entry>> snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries;
+    }
+
+    // Waits out a probe or hook already running, so none runs afterwards
+    void remove(int id);
+};
@@ -0,0 +1,35 @@
+#include "power_stats.h"
+
+#include <cmath>
+
+void PowerStats::add(const std::complex<float> *x, size_t n) {
+    double acc = 0;
+    float top = peak;
+    for (size_t i = 0; i < n; i++) {
+        float p = std::norm(x[i]);
+        uint32_t bits;
+        memcpy(&bits, &p, sizeof(bits));
+        hist[bits >> (23 - mantissa_bits)]++;
+        acc += p;
+        top = std::max(top, p);
+    }
+    sum += acc;
+    peak = top;
+    count += n;
+}
+
+double PowerStats::ccdf(double db) const {
+    if (!count) return 0.0;
+    double level = meanPower() * pow(10.0, db / 10.0);
+    uint64_t above = 0;
+    for (size_t b = finite_bins; b-- > 0 && binFloor(b) >= level;) above += hist[b];
+    return double(above) / count;
+}
+
+double PowerStats::levelAt(double fraction) const {
+    if (!count) return 0.0;
+    uint64_t above = 0, limit = uint64_t(fraction * count);
+    size_t b = finite_bins - 1;
+    while (b > 0 && (above += hist[b]) <= limit) b--;
+    return 10.0 * log10(std::max<double>(binFloor(b), 1e-30) / meanPower());
+}
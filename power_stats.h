@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Per-sample power statistics for CCDF and PAPR. Each sample's power is
+// binned by its float exponent and top mantissa bits, about 0.1 dB wide, so
+// a sample costs an increment instead of a log. Partial results merge.
+class PowerStats {
+public:
+    static constexpr int mantissa_bits = 5;
+    static constexpr size_t bins = size_t(1) << (8 + mantissa_bits);
+    static constexpr size_t finite_bins = size_t(255) << mantissa_bits; // The rest hold Inf and NaN
+
+    PowerStats() : hist(bins) {}
+
+    void add(const std::complex<float> *x, size_t n);
+
+    void merge(const PowerStats &other) {
+        for (size_t b = 0; b < bins; b++) hist[b] += other.hist[b];
+        sum += other.sum;
+        peak = std::max(peak, other.peak);
+        count += other.count;
+    }
+
+    uint64_t samples() const { return count; }
+    double meanPower() const { return count ? sum / count : 0.0; }
+    double peakPower() const { return peak; }
+
+    // Fraction of samples more than 'db' above the mean power
+    double ccdf(double db) const;
+
+    // dB above the mean that only 'fraction' of samples exceed
+    double levelAt(double fraction) const;
+
+private:
+    std::vector<uint64_t> hist;
+    double sum = 0;
+    float peak = 0;
+    uint64_t count = 0;
+
+    static float binFloor(size_t b) {
+        uint32_t bits = uint32_t(b) << (23 - mantissa_bits);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+};
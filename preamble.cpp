@@ -0,0 +1,101 @@
+#include "preamble.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<std::complex<float>> zadoffChu(size_t length, size_t root) {
+    std::vector<std::complex<float>> seq(length);
+    for (size_t n = 0; n < length; n++) {
+        double a = -M_PI * root * n * (n + 1) / length;
+        seq[n] = std::complex<float>(cos(a), sin(a));
+    }
+    return seq;
+}
+
+void PreambleCorrelator::setReference(const std::vector<std::complex<float>> &r, double rate) {
+    ref = r;
+    L = ref.size();
+    sample_rate = rate;
+    N = 1;
+    while (N < 4 * L) N *= 2;
+    fft.resize(N);
+
+    ref_spectrum.assign(N, 0.0f);
+    std::copy(ref.begin(), ref.end(), ref_spectrum.begin());
+    fft.forward(ref_spectrum.data());
+    for (auto &s : ref_spectrum) s = std::conj(s) / float(N); // Folds in the IFFT scale
+    ref_energy = 0;
+    for (auto &s : ref) ref_energy += std::norm(s);
+
+    block.clear();
+    block_start = 0;
+    next_allowed = 0;
+}
+
+void PreambleCorrelator::process(const std::complex<float> *in, size_t n, uint64_t first_index, std::vector<PreambleDetection> &out) {
+    if (L == 0) return;
+    // After a gap (a skipped or dropped frame) the held samples are not
+    // contiguous with these, so the overlap restarts here
+    if (block.empty() || first_index != block_start + block.size()) {
+        block.clear();
+        block_start = first_index;
+    }
+    for (size_t i = 0; i < n; i++) {
+        block.push_back(in[i]);
+        if (block.size() == N) {
+            correlateBlock(out);
+            // Keep the L-1 sample overlap for the next block
+            size_t advance = N - L + 1;
+            block.erase(block.begin(), block.begin() + advance);
+            block_start += advance;
+        }
+    }
+}
+
+void PreambleCorrelator::correlateBlock(std::vector<PreambleDetection> &out) {
+    work = block;
+    fft.forward(work.data());
+    for (size_t k = 0; k < N; k++) work[k] *= ref_spectrum[k];
+    fft.inverse(work.data());
+
+    // Normalize by the energy under the reference at each lag
+    energy_prefix.resize(N + 1);
+    energy_prefix[0] = 0;
+    for (size_t k = 0; k < N; k++) energy_prefix[k + 1] = energy_prefix[k] + std::norm(block[k]);
+
+    size_t valid = N - L + 1;
+    metric.resize(valid);
+    for (size_t j = 0; j < valid; j++) {
+        double e = energy_prefix[j + L] - energy_prefix[j];
+        metric[j] = (e > 0) ? float(std::norm(work[j]) / (e * ref_energy)) : 0.0f;
+    }
+
+    for (size_t j = 0; j < valid; j++) {
+        uint64_t index = block_start + j;
+        if (metric[j] < threshold || index < next_allowed) continue;
+        // Walk to the local maximum (it may sit in the next few lags)
+        while (j + 1 < valid && metric[j + 1] > metric[j]) j++;
+        index = block_start + j;
+
+        PreambleDetection det;
+        det.sample_index = index;
+        det.time_s = 0.0; // Filled in by the caller, which owns the clock
+        det.peak = metric[j];
+        det.timing_offset = 0.0;
+        if (j > 0 && j + 1 < valid) {
+            float a = metric[j - 1], b = metric[j], c = metric[j + 1];
+            float d = a - 2 * b + c;
+            if (d < 0) det.timing_offset = 0.5 * (a - c) / d;
+        }
+
+        // Phase drift between the two halves of the match gives the CFO
+        std::complex<float> c1 = 0.0f, c2 = 0.0f;
+        size_t h = L / 2;
+        for (size_t k = 0; k < h; k++) c1 += block[j + k] * std::conj(ref[k]);
+        for (size_t k = h; k < 2 * h; k++) c2 += block[j + k] * std::conj(ref[k]);
+        det.freq_offset_hz = std::arg(c2 * std::conj(c1)) / (2 * M_PI * h) * sample_rate;
+
+        out.push_back(det);
+        next_allowed = index + L;
+    }
+}
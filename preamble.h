@@ -0,0 +1,50 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Zadoff-Chu sequence: constant amplitude, ideal periodic autocorrelation
+std::vector<std::complex<float>> zadoffChu(size_t length, size_t root);
+
+struct PreambleDetection {
+    uint64_t sample_index;   // Stream index of the preamble's first sample
+    double time_s;           // Stream time of sample_index
+    double timing_offset;    // Sub-sample refinement of sample_index (-0.5..0.5)
+    double freq_offset_hz;
+    float peak;              // Normalized correlation (0..1)
+    double center_hz = 0;    // RX tuning, filled in by the caller
+};
+
+// Finds a known waveform in the stream with overlap-save FFT correlation.
+// The conjugated reference spectrum is computed once, so each block of N
+// samples costs two FFTs instead of N*L multiplies; consecutive blocks
+// overlap by L-1 so every lag is evaluated exactly once.
+class PreambleCorrelator {
+public:
+    float threshold = 0.5f;
+
+    void setReference(const std::vector<std::complex<float>> &r, double rate);
+
+    size_t referenceLength() const { return L; }
+
+    // 'first_index' is the stream index of in[0]; detections are appended to 'out'
+    void process(const std::complex<float> *in, size_t n, uint64_t first_index, std::vector<PreambleDetection> &out);
+
+private:
+    std::vector<std::complex<float>> ref, ref_spectrum, work;
+    std::vector<float> metric;
+    std::vector<double> energy_prefix;
+    size_t L = 0, N = 0;
+    double sample_rate = 1.0;
+    double ref_energy = 1.0;
+    FFT fft;
+    std::vector<std::complex<float>> block;
+    uint64_t block_start = 0;
+    uint64_t next_allowed = 0; // Holdoff so one preamble yields one detection
+
+    void correlateBlock(std::vector<PreambleDetection> &out);
+};
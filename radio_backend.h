@@ -0,0 +1,70 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What the worker needs from a radio. The UHD implementation lives in a
+// plugin (libusrp_viz_uhd.so) that is dlopen'ed the first time hardware is
+// asked for, so the application itself never links libuhd.
+
+struct RadioDeviceInfo {
+    std::string label; // For the device list, e.g. "b200 (30F1A2B)"
+    std::string args;  // Device address string to open it with
+};
+
+struct RadioConfig {
+    double rate;
+    double freq;
+    double tx_gain;
+    double rx_gain;
+    size_t tx_spp = 0;        // Samples per TX packet, 0 for the transport default
+    size_t tx_frames = 0;     // TX frames in flight, 0 for the transport default
+    size_t tx_buff_bytes = 0; // TX socket buffer, 0 for the transport default
+    bool rx = true;           // Start continuous RX; off when only TX is exercised
+};
+
+class RadioBackend {
+public:
+    virtual ~RadioBackend() = default;
+
+    virtual std::vector<RadioDeviceInfo> findDevices() = 0;
+
+    // Configures both directions and starts continuous RX if config.rx.
+    // Throws on failure.
+    virtual void open(const std::string &args, const RadioConfig &config) = 0;
+    // Stops RX and ends the TX burst
+    virtual void close() = 0;
+    // Rebuilds both streamers with new transport settings; the device, its
+    // tuning and gains stay as they are. Throws on failure.
+    virtual void restartStreams(const RadioConfig &config) = 0;
+
+    virtual void setTxFreq(double hz) = 0;
+    virtual void setTxGain(double db) = 0;
+    virtual void setRxGain(double db) = 0;
+    // Settable RX gain of the open device, in dB
+    virtual void rxGainRange(double &min_db, double &max_db) = 0;
+    // Timed retune 'lead_s' from now; returns the device time it applies at
+    virtual double tuneRxAt(double hz, double lead_s) = 0;
+    // Timed RX gain change, likewise
+    virtual double setRxGainAt(double db, double lead_s) = 0;
+
+    virtual size_t send(const std::complex<float> *samples, size_t n, double timeout_s) = 0;
+    // Ends the TX burst and waits until the device has played out everything
+    // queued; returns how long that took in seconds, or -1 if the device did
+    // not confirm it within timeout_s. The next send() starts a new burst.
+    virtual double endTxBurst(double timeout_s) = 0;
+    // has_time/time_s describe samples[0] when the device timestamps it
+    virtual size_t recv(std::complex<float> *samples, size_t n, double timeout_s, bool &has_time, double &time_s) = 0;
+
+    // Stream faults since the last call: TX ran dry, RX samples were dropped
+    virtual bool takeTxUnderflow() = 0;
+    virtual bool takeRxOverflow() = 0;
+};
+
+// Exported by a backend plugin under this name
+extern "C" {
+typedef RadioBackend *(*CreateRadioBackendFn)();
+}
+#define RADIO_BACKEND_ENTRY "createRadioBackend"
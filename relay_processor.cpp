@@ -0,0 +1,32 @@
+#include "relay_processor.h"
+#include "decimators.h"
+
+#include <algorithm>
+#include <cmath>
+
+void RelayProcessor::configure(double rate, double shift_hz, double gain_db, bool filter, double cutoff_hz) {
+    double w = 2.0 * M_PI * shift_hz / rate;
+    rot_step = std::complex<float>(cos(w), sin(w));
+    gain = pow(10.0, gain_db / 20.0);
+    taps = filter ? lowpassTaps(31, cutoff_hz / rate) : std::vector<float>();
+    hist.assign(2 * std::max<size_t>(1, taps.size()), 0.0f);
+    write_pos = 0;
+}
+
+void RelayProcessor::process(std::complex<float> *x, size_t n) {
+    size_t len = taps.size();
+    for (size_t i = 0; i < n; i++) {
+        std::complex<float> s = x[i];
+        if (len) {
+            write_pos = (write_pos + 1) % len;
+            hist[write_pos] = s;
+            hist[write_pos + len] = s;
+            const std::complex<float> *newest = &hist[write_pos + len];
+            s = 0.0f;
+            for (size_t j = 0; j < len; j++) s += taps[j] * *(newest - j);
+        }
+        x[i] = s * rot * gain;
+        rot *= rot_step;
+    }
+    rot /= std::abs(rot);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// In-place DSP for the relay path: frequency shift, optional lowpass and
+// gain. The filter is short and symmetric, so it adds a fixed
+// (taps - 1) / 2 samples of delay.
+class RelayProcessor {
+public:
+    void configure(double rate, double shift_hz, double gain_db, bool filter, double cutoff_hz);
+
+    void process(std::complex<float> *x, size_t n);
+
+private:
+    std::complex<float> rot = 1.0f, rot_step = 1.0f;
+    float gain = 1.0f;
+    std::vector<float> taps;
+    std::vector<std::complex<float>> hist;
+    size_t write_pos = 0;
+};
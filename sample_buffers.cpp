@@ -0,0 +1,61 @@
+#include "sample_buffers.h"
+
+#include <new>
+
+#include <sys/mman.h>
+
+void *HugePages::map(size_t bytes, Mode limit) {
+    size_t len = roundUp(bytes);
+    if (!enabled) limit = Normal;
+    void *p = MAP_FAILED;
+    Mode got = Normal;
+    if (limit >= Explicit) {
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        got = Explicit;
+    }
+    if (p == MAP_FAILED) {
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        got = (limit >= Transparent && madvise(p, len, MADV_HUGEPAGE) == 0) ? Transparent : Normal;
+        if (got == Normal) madvise(p, len, MADV_NOHUGEPAGE);
+    }
+    std::lock_guard<std::mutex> lock(registryMutex());
+    registry()[p] = got;
+    mapped[got] += len;
+    return p;
+}
+
+void HugePages::unmap(void *p, size_t bytes) {
+    size_t len = roundUp(bytes);
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(p);
+        if (it != registry().end()) {
+            mapped[it->second] -= len;
+            registry().erase(it);
+        }
+    }
+    munmap(p, len);
+}
+
+void *HugePageArena::allocate(size_t bytes) {
+    int c = sizeClass(bytes);
+    size_t piece = size_t(1) << c;
+    std::lock_guard<std::mutex> lock(state().mutex);
+    State &st = state();
+    if (!st.free[c].empty()) {
+        void *p = st.free[c].back();
+        st.free[c].pop_back();
+        st.in_use += piece;
+        return p;
+    }
+    size_t at = (st.used + align - 1) / align * align;
+    if (!st.current || at + piece > HugePages::page) {
+        st.current = static_cast<char *>(HugePages::map(HugePages::page));
+        st.pages++;
+        at = 0;
+    }
+    st.used = at + piece;
+    st.in_use += piece;
+    return st.current + at;
+}
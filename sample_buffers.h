@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Large sample buffers are mapped with explicit huge pages (MAP_HUGETLB) when
+// the system has some reserved, otherwise with transparent huge pages
+// (MADV_HUGEPAGE), otherwise as ordinary pages. Fewer, bigger pages keep TLB
+// misses down when the radio path and viewers sweep through hundreds of MB.
+// Allocations below 'threshold' aren't worth a 2 MB page of their own; the
+// long-lived ones share pages through HugePageArena, the rest use the heap.
+class HugePages {
+public:
+    enum Mode { Normal = 0, Transparent = 1, Explicit = 2 };
+
+    static constexpr size_t page = 2u << 20;
+    static constexpr size_t threshold = 1u << 20;
+    static inline std::atomic<bool> enabled{true};
+
+    static size_t roundUp(size_t bytes) { return (bytes + page - 1) / page * page; }
+
+    // Best mode not above 'limit'; the mode actually obtained is recorded
+    static void *map(size_t bytes, Mode limit = Explicit);
+
+    static void unmap(void *p, size_t bytes);
+
+    // Bytes currently mapped in each mode
+    static size_t bytesMapped(Mode m) { return mapped[m].load(); }
+
+    static Mode modeOf(void *p) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(p);
+        return it == registry().end() ? Normal : it->second;
+    }
+
+private:
+    static inline std::atomic<size_t> mapped[3] = {};
+    static std::mutex &registryMutex() { static std::mutex m; return m; }
+    static std::map<void *, Mode> &registry() { static std::map<void *, Mode> r; return r; }
+};
+
+// Huge pages shared by the long-lived buffers below HugePages::threshold
+// (history rings, waveform renders, small block pools). Sizes are rounded up to a
+// power of two; a size with no free piece takes one from the end of the
+// current page, and freed pieces are kept for the same size. Pages stay
+// mapped for the life of the process, so the arena holds the peak in use.
+class HugePageArena {
+public:
+    static void *allocate(size_t bytes);
+
+    static void deallocate(void *p, size_t bytes) {
+        int c = sizeClass(bytes);
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().free[c].push_back(p);
+        state().in_use -= size_t(1) << c;
+    }
+
+    static size_t bytesMapped() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().pages * HugePages::page;
+    }
+    static size_t bytesInUse() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        return state().in_use;
+    }
+
+private:
+    static constexpr int min_class = 6; // 64 bytes, one cache line
+    static constexpr int max_class = 20; // HugePages::threshold
+    static constexpr size_t align = 64;
+
+    struct State {
+        std::mutex mutex;
+        std::vector<void *> free[max_class + 1];
+        char *current = nullptr;
+        size_t used = 0; // Bytes of 'current' handed out
+        size_t pages = 0, in_use = 0;
+    };
+    // Never destroyed: static buffers may be freed after it would have been
+    static State &state() {
+        static State *st = new State;
+        return *st;
+    }
+
+    static int sizeClass(size_t bytes) {
+        int c = min_class;
+        while ((size_t(1) << c) < bytes) c++;
+        return c;
+    }
+};
+
+// std::allocator drop-in that puts big allocations on huge pages of their
+// own. Small ones come from the heap, or from the shared arena with 'Arena',
+// which is only for buffers kept for a session: the arena never gives its
+// pages back, so churning vectors would pin their peak there.
+template <typename T, bool Arena = false>
+struct HugePageAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = HugePageAllocator<U, Arena>; };
+    HugePageAllocator() = default;
+    template <typename U> HugePageAllocator(const HugePageAllocator<U, Arena> &) {}
+
+    T *allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= HugePages::threshold) return static_cast<T *>(HugePages::map(bytes));
+        if (Arena) return static_cast<T *>(HugePageArena::allocate(bytes));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= HugePages::threshold) HugePages::unmap(p, bytes);
+        else if (Arena) HugePageArena::deallocate(p, bytes);
+        else std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const HugePageAllocator<U, Arena> &) const { return true; }
+    template <typename U> bool operator!=(const HugePageAllocator<U, Arena> &) const { return false; }
+};
+
+using SampleVector = std::vector<std::complex<float>, HugePageAllocator<std::complex<float>>>;
+using PowerVector = std::vector<float, HugePageAllocator<float>>;
+// History rings, block pools and cached waveforms
+using ArenaSampleVector = std::vector<std::complex<float>, HugePageAllocator<std::complex<float>, true>>;
+
+// Split I/Q: all I values in one array, all Q values in another. Filters,
+// mixers and discriminators then work on whole vectors of I or Q without
+// the shuffles that interleaved std::complex data needs. A planar stage
+// converts its input once, on the way in.
+struct PlanarSamples {
+    PowerVector i, q;
+
+    size_t size() const { return i.size(); }
+    void resize(size_t n) { i.resize(n); q.resize(n); }
+    void clear() { i.clear(); q.clear(); }
+};
+
+inline void deinterleave(const std::complex<float> *in, size_t n, float *i, float *q) {
+    const float *x = reinterpret_cast<const float *>(in);
+    for (size_t k = 0; k < n; k++) {
+        i[k] = x[2 * k];
+        q[k] = x[2 * k + 1];
+    }
+}
+
+// Mean and peak of |x|^2 over one block
+struct BlockPower {
+    double mean = 0;
+    float peak = 0;
+};
+
+// Eight independent lanes, so the sums are not one long dependency chain
+inline BlockPower blockPower(const std::complex<float> *in, size_t n) {
+    const float *x = reinterpret_cast<const float *>(in);
+    float sum[8] = {}, top[8] = {};
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            float re = x[2 * (k + j)], im = x[2 * (k + j) + 1];
+            float p = re * re + im * im;
+            sum[j] += p;
+            top[j] = p > top[j] ? p : top[j];
+        }
+    }
+    for (; k < n; k++) {
+        float p = x[2 * k] * x[2 * k] + x[2 * k + 1] * x[2 * k + 1];
+        sum[0] += p;
+        top[0] = std::max(top[0], p);
+    }
+    BlockPower bp;
+    for (size_t j = 0; j < 8; j++) {
+        bp.mean += sum[j];
+        bp.peak = std::max(bp.peak, top[j]);
+    }
+    if (n) bp.mean /= n;
+    return bp;
+}
+
+inline void interleave(const float *i, const float *q, size_t n, std::complex<float> *out) {
+    float *x = reinterpret_cast<float *>(out);
+    for (size_t k = 0; k < n; k++) {
+        x[2 * k] = i[k];
+        x[2 * k + 1] = q[k];
+    }
+}
@@ -0,0 +1,43 @@
+#include "sim_channel.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SimChannel::propagate(const std::vector<std::complex<float>> &tx, double tx_freq, double rx_freq,
+                           double rate, std::vector<std::complex<float>> &rx) {
+    mix(tx, tx_freq, rx_freq, rate, rx);
+    // The ADC clips each rail at full scale
+    float scale = std::pow(10.0f, float(rx_gain_db - 30.0) / 20.0f);
+    if (scale == 1.0f) return;
+    for (auto &x : rx) {
+        x = std::complex<float>(std::max(-1.0f, std::min(1.0f, x.real() * scale)),
+                                std::max(-1.0f, std::min(1.0f, x.imag() * scale)));
+    }
+}
+
+void SimChannel::mix(const std::vector<std::complex<float>> &tx, double tx_freq, double rx_freq,
+                     double rate, std::vector<std::complex<float>> &rx) {
+    rx.resize(tx.size());
+    double offset = tx_freq - rx_freq;
+    bool in_band = std::abs(offset) < rate / 2;
+    double increment = 2.0 * M_PI * offset / rate;
+    std::normal_distribution<float> gauss(0.0f, noise_rms / std::sqrt(2.0f));
+    for (size_t i = 0; i < tx.size(); i++) {
+        std::complex<float> s(gauss(rng), gauss(rng));
+        std::complex<float> x = iq_impaired ? modulate(tx[i]) : tx[i];
+        if (pa_enabled) x = amplify(x);
+        if (in_band) s += x * std::complex<float>(cos(phase), sin(phase));
+        rx[i] = s;
+        phase += increment;
+    }
+    phase = fmod(phase, 2 * M_PI);
+}
+
+std::complex<float> SimChannel::amplify(std::complex<float> x) {
+    std::complex<float> v = x + 0.1f * pa_prev;
+    pa_prev = x;
+    float r2 = std::norm(v);
+    float g = 1.0f / (1.0f + 0.25f * r2);
+    float phi = 0.4f * r2 / (1.0f + r2);
+    return v * g * std::complex<float>(cos(phi), sin(phi));
+}
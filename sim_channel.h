@@ -0,0 +1,41 @@
+#pragma once
+
+#include <complex>
+#include <random>
+#include <vector>
+
+// Stand-in for the air interface when no hardware is attached: the TX block is
+// moved by the TX/RX tuning offset and buried in white Gaussian noise.
+// Optionally a compressing PA with a little memory sits in front, as a
+// target for the predistorter, and the modulator can have IQ imbalance
+// and LO leakage for the IQ calibration to find. The RX gain scales what
+// arrives, and the ADC clips it at full scale.
+class SimChannel {
+public:
+    float noise_rms = 1e-3f; // Roughly -60 dBFS total
+    bool pa_enabled = false;
+    bool iq_impaired = false;
+    double rx_gain_db = 30.0; // Scales the received block; 30 dB passes it unchanged
+
+    void propagate(const std::vector<std::complex<float>> &tx, double tx_freq, double rx_freq,
+                   double rate, std::vector<std::complex<float>> &rx);
+
+private:
+    void mix(const std::vector<std::complex<float>> &tx, double tx_freq, double rx_freq,
+             double rate, std::vector<std::complex<float>> &rx);
+
+    std::mt19937 rng{12345};
+    double phase = 0.0;
+    std::complex<float> pa_prev = 0.0f;
+
+    // 0.5 dB gain and 3 degree phase mismatch (about -30 dBc image) and
+    // -34 dBFS of carrier leakage
+    static std::complex<float> modulate(std::complex<float> x) {
+        const float g = 1.0593f, s = 0.0523f, c = 0.9986f;
+        return std::complex<float>(x.real() + 0.015f, g * (c * x.imag() + s * x.real()) + 0.012f);
+    }
+
+    // Saleh-style AM/AM and AM/PM behind a one-tap memory; about 2 dB of
+    // compression and 0.2 rad of phase shift at full scale
+    std::complex<float> amplify(std::complex<float> x);
+};
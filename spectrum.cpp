@@ -0,0 +1,259 @@
+#include "spectrum.h"
+
+#include <numeric>
+#include <sstream>
+
+void SpectrumAnalyzer::configure(size_t n) {
+    fft.resize(n);
+    window.resize(n);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        window[i] = 0.5f - 0.5f * cos(2.0 * M_PI * i / n); // Hann
+        sum += window[i];
+    }
+    norm = 1.0f / (sum * sum);
+    scratch.resize(n);
+}
+
+void SpectrumAnalyzer::power(const std::complex<float> *in, std::vector<float> &psd) {
+    size_t n = fft.size();
+    for (size_t i = 0; i < n; i++) scratch[i] = in[i] * window[i];
+    fft.forward(scratch.data());
+    psd.resize(n);
+    for (size_t i = 0; i < n; i++) psd[i] = std::norm(scratch[(i + n / 2) % n]) * norm;
+}
+
+void BinReducer::reduce(const float *bins, size_t first, size_t last, size_t columns, Mode mode,
+                        std::vector<float> &pos, std::vector<float> &val) {
+    pos.clear();
+    val.clear();
+    if (last <= first || columns == 0) return;
+    size_t n = last - first;
+    if (n <= columns) {
+        for (size_t i = first; i < last; i++) {
+            pos.push_back(i);
+            val.push_back(bins[i]);
+        }
+        return;
+    }
+    double per_column = double(n) / columns;
+    for (size_t c = 0; c < columns; c++) {
+        size_t a = first + size_t(c * per_column), b = first + size_t((c + 1) * per_column);
+        float center = 0.5f * (a + b - 1);
+        if (mode == Peak) {
+            pos.push_back(center);
+            val.push_back(maxOf(bins + a, b - a));
+        } else if (mode == Average) {
+            pos.push_back(center);
+            val.push_back(sumOf(bins + a, b - a) / (b - a));
+        } else {
+            pos.push_back(center);
+            val.push_back(minOf(bins + a, b - a));
+            pos.push_back(center);
+            val.push_back(maxOf(bins + a, b - a));
+        }
+    }
+}
+
+float BinReducer::maxOf(const float *x, size_t n) {
+    float lanes[8];
+    std::fill(lanes, lanes + 8, -INFINITY);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        for (size_t j = 0; j < 8; j++) lanes[j] = x[i + j] > lanes[j] ? x[i + j] : lanes[j];
+    for (; i < n; i++) lanes[0] = std::max(lanes[0], x[i]);
+    return *std::max_element(lanes, lanes + 8);
+}
+
+float BinReducer::minOf(const float *x, size_t n) {
+    float lanes[8];
+    std::fill(lanes, lanes + 8, INFINITY);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        for (size_t j = 0; j < 8; j++) lanes[j] = x[i + j] < lanes[j] ? x[i + j] : lanes[j];
+    for (; i < n; i++) lanes[0] = std::min(lanes[0], x[i]);
+    return *std::min_element(lanes, lanes + 8);
+}
+
+float BinReducer::sumOf(const float *x, size_t n) {
+    float lanes[8] = {};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        for (size_t j = 0; j < 8; j++) lanes[j] += x[i + j];
+    for (; i < n; i++) lanes[0] += x[i];
+    return std::accumulate(lanes, lanes + 8, 0.0f);
+}
+
+float EnergyDetector::process(const std::vector<float> &psd_db, double center_hz, double rate, double time_s,
+                              std::vector<DetectionEvent> &out) {
+    if (psd_db.empty()) return 0.0f;
+    float floor_db = noiseFloor(psd_db);
+    float limit = floor_db + threshold_db;
+    double bin_hz = rate / psd_db.size();
+    double f0 = center_hz - rate / 2;
+
+    size_t n = psd_db.size();
+    size_t i = 0;
+    while (i < n) {
+        if (psd_db[i] <= limit) { i++; continue; }
+        size_t start = i;
+        float peak = psd_db[i];
+        while (i < n && psd_db[i] > limit) { peak = std::max(peak, psd_db[i]); i++; }
+        out.push_back({time_s, f0 + start * bin_hz, f0 + i * bin_hz, peak, floor_db});
+    }
+    return floor_db;
+}
+
+bool RxAgc::update(const BlockPower &p, double seconds, double &gain_db) {
+    double level = 10.0 * std::log10(p.mean + 1e-20);
+    if (!primed) {
+        smoothed = level;
+        primed = true;
+    } else {
+        double tau = level > smoothed ? attack_s : decay_s;
+        smoothed += (1.0 - std::exp(-seconds / tau)) * (level - smoothed);
+    }
+
+    double step;
+    if (10.0 * std::log10(p.peak + 1e-20) >= clip_dbfs) {
+        // A clipped block reads low, so it always costs at least 6 dB
+        step = std::min(-6.0, target_dbfs - std::max(level, smoothed));
+    } else if (std::abs(smoothed - target_dbfs) > hysteresis_db) {
+        step = target_dbfs - smoothed;
+    } else {
+        return false;
+    }
+    step = std::max(-max_step_db, std::min(max_step_db, step));
+    double next = std::max(min_gain_db, std::min(max_gain_db, std::round(gain + step)));
+    if (next == gain) return false;
+    smoothed += next - gain;
+    gain = next;
+    gain_db = next;
+    return true;
+}
+
+bool SpectrumMask::parse(const std::string &text, std::vector<MaskPoint> &out) {
+    out.clear();
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        double khz;
+        float db;
+        char colon;
+        std::istringstream field(item);
+        if (!(field >> khz >> colon >> db) || colon != ':') return false;
+        if (!out.empty() && khz * 1e3 <= out.back().offset_hz) return false;
+        out.push_back({khz * 1e3, db});
+    }
+    return out.size() >= 2;
+}
+
+void SpectrumMask::configure(const std::vector<MaskPoint> &points, bool is_relative, size_t bins, double rate) {
+    relative = is_relative;
+    bool symmetric = points.front().offset_hz >= 0;
+    limit.resize(bins);
+    for (size_t k = 0; k < bins; k++) {
+        double f = -rate / 2 + k * rate / bins;
+        if (symmetric) f = fabs(f);
+        limit[k] = interpolate(points, f);
+    }
+}
+
+SpectrumMask::Result SpectrumMask::check(const float *psd_db, size_t n) const {
+    float ref = relative ? *std::max_element(psd_db, psd_db + n) : 0.0f;
+    const float *lim = limit.data();
+    // Eight independent minimums, so the loop vectorizes without
+    // reassociating a single floating-point reduction
+    float lanes[8];
+    std::fill(lanes, lanes + 8, INFINITY);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            float m = lim[i + j] + ref - psd_db[i + j];
+            lanes[j] = m < lanes[j] ? m : lanes[j];
+            count += m < 0.0f;
+        }
+    }
+    for (; i < n; i++) {
+        float m = lim[i] + ref - psd_db[i];
+        lanes[0] = std::min(lanes[0], m);
+        count += m < 0.0f;
+    }
+    return {count, *std::min_element(lanes, lanes + 8), ref};
+}
+
+float SpectrumMask::interpolate(const std::vector<MaskPoint> &p, double f) {
+    if (f <= p.front().offset_hz) return p.front().limit_db;
+    if (f >= p.back().offset_hz) return p.back().limit_db;
+    size_t k = 1;
+    while (p[k].offset_hz < f) k++;
+    double t = (f - p[k - 1].offset_hz) / (p[k].offset_hz - p[k - 1].offset_hz);
+    return float(p[k - 1].limit_db + t * (p[k].limit_db - p[k - 1].limit_db));
+}
+
+PanoramaStitcher::~PanoramaStitcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void PanoramaStitcher::begin(double start_hz, double stop_hz, double rate, size_t fft_size, double keep) {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs.clear();
+    cv.wait(lock, [this] { return !busy; }); // Let an in-flight segment finish
+    analyzer.configure(fft_size);
+    kept_bins = size_t(fft_size * keep);
+    usable_hz = rate * kept_bins / fft_size;
+    segments = std::max<size_t>(1, size_t(std::ceil((stop_hz - start_hz) / usable_hz)));
+    first_center = start_hz + usable_hz / 2;
+    trace.assign(segments * kept_bins, -200.0f);
+}
+
+void PanoramaStitcher::submit(size_t k, const std::complex<float> *samples, size_t n) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({k, std::vector<std::complex<float>>(samples, samples + n)});
+    }
+    cv.notify_one();
+}
+
+bool PanoramaStitcher::takeSweep(std::vector<float> &out, double &sweep_seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!sweep_ready) return false;
+    out.assign(completed.begin(), completed.end());
+    sweep_seconds = completed_seconds;
+    sweep_ready = false;
+    return true;
+}
+
+void PanoramaStitcher::processLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return quit || !jobs.empty(); });
+        if (quit) return;
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        if (job.segment >= segments || job.samples.size() != analyzer.size()) continue;
+
+        // FFT outside the lock; begin() waits on 'busy' before reconfiguring
+        busy = true;
+        lock.unlock();
+        analyzer.process(job.samples.data(), psd_db);
+        lock.lock();
+        busy = false;
+        cv.notify_all();
+
+        size_t skip = (psd_db.size() - kept_bins) / 2;
+        std::copy(psd_db.begin() + skip, psd_db.begin() + skip + kept_bins,
+                  trace.begin() + job.segment * kept_bins);
+
+        if (job.segment == segments - 1) {
+            completed = trace;
+            completed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sweep_start).count();
+            sweep_ready = true;
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "fft.h"
+#include "sample_buffers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Windowed power spectrum in dBFS, FFT-shifted so bin 0 is -fs/2.
+// A full-scale complex tone reads 0 dBFS.
+class SpectrumAnalyzer {
+public:
+    void configure(size_t n);
+
+    size_t size() const { return fft.size(); }
+
+    void process(const std::complex<float> *in, std::vector<float> &psd_db) {
+        power(in, psd_db);
+        for (float &p : psd_db) p = 10.0f * log10f(p + 1e-20f);
+    }
+
+    // Linear power per bin (a full-scale tone reads 1), laid out as process()
+    void power(const std::complex<float> *in, std::vector<float> &psd);
+
+private:
+    FFT fft;
+    std::vector<float> window;
+    std::vector<std::complex<float>> scratch;
+    float norm = 1.0f;
+};
+
+// Reduces a span of spectrum bins to one value per pixel column (two for
+// Envelope), so drawing costs the plot width rather than the FFT size. Peak
+// keeps a one-bin spur that subsampling would step over; Average is the mean
+// in dB. Spans with fewer bins than columns pass through unreduced.
+class BinReducer {
+public:
+    enum Mode { Peak = 0, Average = 1, Envelope = 2 };
+
+    // Bins [first, last) into 'columns'; 'pos' gets each value's bin position
+    static void reduce(const float *bins, size_t first, size_t last, size_t columns, Mode mode,
+                       std::vector<float> &pos, std::vector<float> &val);
+
+    // Eight independent lanes, so each loop vectorizes without reassociating
+    // a single floating-point reduction
+    static float maxOf(const float *x, size_t n);
+
+    static float minOf(const float *x, size_t n);
+
+    static float sumOf(const float *x, size_t n);
+};
+
+struct DetectionEvent {
+    double time_s;        // Stream time of the FFT frame
+    double start_hz;      // Absolute RF edges of the occupied bins
+    double stop_hz;
+    float peak_db;
+    float noise_floor_db;
+    float rx_gain_db = 0; // Device RX gain, to refer the levels to the input
+};
+
+// Flags contiguous runs of bins that sit a fixed margin above the noise floor.
+// The floor is a percentile over all bins (median by default), found with
+// nth_element so the whole detector stays O(N) per frame.
+class EnergyDetector {
+public:
+    float threshold_db = 10.0f;
+    float percentile = 0.5f;
+
+    float noiseFloor(const std::vector<float> &psd_db) {
+        scratch = psd_db;
+        size_t k = std::min(scratch.size() - 1, size_t(percentile * scratch.size()));
+        std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+        return scratch[k];
+    }
+
+    // Returns the noise floor used; detections are appended to 'out'.
+    float process(const std::vector<float> &psd_db, double center_hz, double rate, double time_s,
+                  std::vector<DetectionEvent> &out);
+
+private:
+    std::vector<float> scratch;
+};
+
+// Software AGC for the RX front end. It is fed each block's power as the
+// block is split and answers with a new device gain when one is due. The
+// level is smoothed with a fast attack (rising power) and a slow decay, and
+// the gain only moves once that level leaves target +- hysteresis, so it
+// does not hunt on modulation. A block that comes near full scale steps the
+// gain down at once. The caller applies the gain with a timed command and
+// stops feeding blocks until it is in effect; the smoothed level is moved
+// by the step so it does not have to re-converge.
+class RxAgc {
+public:
+    double target_dbfs = -20.0; // Mean level to hold
+    double hysteresis_db = 4.0; // No change while within target +- this
+    double attack_s = 0.002;    // Smoothing while the level rises
+    double decay_s = 0.5;       // Smoothing while it falls
+    double clip_dbfs = -1.0;    // A peak at or above this steps down at once
+    double max_step_db = 20.0;
+    double min_gain_db = 0.0;  // Set from the device's range
+    double max_gain_db = 76.0;
+
+    void reset(double gain_db) {
+        gain = gain_db;
+        primed = false;
+    }
+
+    // 'seconds' is the block length. Returns true with the gain to apply.
+    bool update(const BlockPower &p, double seconds, double &gain_db);
+
+    double level() const { return smoothed; } // Smoothed dBFS
+
+private:
+    double gain = 0.0;
+    double smoothed = -120.0;
+    bool primed = false;
+};
+
+// One corner of an emission mask
+struct MaskPoint {
+    double offset_hz; // From the RX center
+    float limit_db;   // dBc for relative masks, dBFS otherwise
+};
+
+// Emission mask test. The piecewise-linear mask is expanded once into one
+// limit per FFT bin, so each frame costs a single pass over the spectrum.
+// Relative (dBc) masks are referenced to the frame's peak bin. A mask given
+// only for offsets >= 0 applies to both sides.
+class SpectrumMask {
+public:
+    struct Result {
+        size_t violations;     // Bins over the limit
+        float worst_margin_db; // Smallest limit - level; negative fails
+        float reference_db;    // Carrier level for dBc masks, else 0
+    };
+
+    // "offset_khz:limit_db, ..." in increasing offset order
+    static bool parse(const std::string &text, std::vector<MaskPoint> &out);
+
+    void configure(const std::vector<MaskPoint> &points, bool is_relative, size_t bins, double rate);
+
+    Result check(const float *psd_db, size_t n) const;
+
+    size_t bins() const { return limit.size(); }
+    bool isRelative() const { return relative; }
+    const PowerVector &limits() const { return limit; }
+
+private:
+    PowerVector limit; // Per bin, relative to the reference
+    bool relative = false;
+
+    // Linear between points, flat beyond the ends
+    static float interpolate(const std::vector<MaskPoint> &p, double f);
+};
+
+// Stitches retuned RX captures into one trace wider than the instantaneous
+// bandwidth. Segments are FFT'd on a helper thread so the radio loop can tune
+// and capture segment k+1 while segment k is processed. Only the central
+// 'keep' fraction of each segment is used, trimming the filter roll-off.
+class PanoramaStitcher {
+public:
+    PanoramaStitcher() : thread([this] { processLoop(); }) {}
+
+    ~PanoramaStitcher();
+
+    void begin(double start_hz, double stop_hz, double rate, size_t fft_size, double keep = 0.8);
+
+    size_t segmentCount() const { return segments; }
+    double segmentCenter(size_t k) const { return first_center + k * usable_hz; }
+    double traceStart() const { return first_center - usable_hz / 2; }
+    double traceStop() const { return traceStart() + segments * usable_hz; }
+
+    // Trace, last completed sweep and queued segments
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = (trace.size() + completed.size()) * sizeof(float);
+        for (const auto &job : jobs) n += job.samples.size() * sizeof(std::complex<float>);
+        return n;
+    }
+
+    // Marks the moment the first segment of a sweep was tuned
+    void startSweep() {
+        std::lock_guard<std::mutex> lock(mutex);
+        sweep_start = std::chrono::steady_clock::now();
+    }
+
+    void submit(size_t k, const std::complex<float> *samples, size_t n);
+
+    // Returns true (once) when a full sweep has been stitched since the last call
+    bool takeSweep(std::vector<float> &out, double &sweep_seconds);
+
+private:
+    struct Job {
+        size_t segment;
+        std::vector<std::complex<float>> samples;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    bool quit = false;
+    bool busy = false;
+
+    SpectrumAnalyzer analyzer;
+    size_t kept_bins = 0;
+    size_t segments = 0;
+    double usable_hz = 0;
+    double first_center = 0;
+    PowerVector trace; // A GHz-wide sweep runs to millions of bins
+    std::vector<float> psd_db;
+
+    std::chrono::steady_clock::time_point sweep_start;
+    PowerVector completed;
+    double completed_seconds = 0;
+    bool sweep_ready = false;
+
+    std::thread thread; // Declared last so everything above exists before it runs
+
+    void processLoop();
+};
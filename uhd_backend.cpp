@@ -0,0 +1,157 @@
+// UHD implementation of RadioBackend, built as a plugin so that libuhd and
+// its transports are only loaded when hardware is actually used.
+#include "radio_backend.h"
+
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/device.hpp>
+#include <uhd/stream.hpp>
+
+#include <chrono>
+
+class UhdBackend : public RadioBackend {
+public:
+    std::vector<RadioDeviceInfo> findDevices() override {
+        std::vector<RadioDeviceInfo> out;
+        uhd::device_addrs_t devices = uhd::device::find(uhd::device_addr_t(""));
+        for (const auto &dev : devices) {
+            out.push_back({dev.get("type") + " (" + dev.get("serial") + ")", dev.to_string()});
+        }
+        return out;
+    }
+
+    void open(const std::string &args, const RadioConfig &config) override {
+        usrp = uhd::usrp::multi_usrp::make(uhd::device_addr_t(args));
+        usrp->set_tx_rate(config.rate);
+        usrp->set_tx_freq(config.freq);
+        usrp->set_tx_gain(config.tx_gain);
+        usrp->set_rx_rate(config.rate);
+        usrp->set_rx_freq(config.freq);
+        usrp->set_rx_gain(config.rx_gain);
+        startStreams(config);
+    }
+
+    void close() override {
+        if (!usrp) return;
+        if (rx_stream) rx_stream->issue_stream_cmd(uhd::stream_cmd_t(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+        md.end_of_burst = true;
+        tx_stream->send("", 0, md);
+    }
+
+    void restartStreams(const RadioConfig &config) override {
+        close();
+        // UHD hands out one streamer per channel, so the old ones go first
+        tx_stream.reset();
+        rx_stream.reset();
+        startStreams(config);
+    }
+
+    void setTxFreq(double hz) override { usrp->set_tx_freq(hz); }
+    void setTxGain(double db) override { usrp->set_tx_gain(db); }
+    void setRxGain(double db) override { usrp->set_rx_gain(db); }
+
+    void rxGainRange(double &min_db, double &max_db) override {
+        uhd::gain_range_t range = usrp->get_rx_gain_range();
+        min_db = range.start();
+        max_db = range.stop();
+    }
+
+    double tuneRxAt(double hz, double lead_s) override {
+        uhd::time_spec_t cmd_time = usrp->get_time_now() + uhd::time_spec_t(lead_s);
+        usrp->set_command_time(cmd_time);
+        usrp->set_rx_freq(uhd::tune_request_t(hz));
+        usrp->clear_command_time();
+        return cmd_time.get_real_secs();
+    }
+
+    double setRxGainAt(double db, double lead_s) override {
+        uhd::time_spec_t cmd_time = usrp->get_time_now() + uhd::time_spec_t(lead_s);
+        usrp->set_command_time(cmd_time);
+        usrp->set_rx_gain(db);
+        usrp->clear_command_time();
+        return cmd_time.get_real_secs();
+    }
+
+    size_t send(const std::complex<float> *samples, size_t n, double timeout_s) override {
+        size_t sent = tx_stream->send(samples, n, md, timeout_s);
+        md.start_of_burst = false;
+        return sent;
+    }
+
+    // The burst ACK is timestamped by the device, so the wait is timed on the
+    // device clock from just before the end of burst was queued
+    double endTxBurst(double timeout_s) override {
+        double queued_at = usrp->get_time_now().get_real_secs();
+        auto host_queued_at = std::chrono::steady_clock::now();
+        md.end_of_burst = true;
+        tx_stream->send("", 0, md);
+        md.end_of_burst = false;
+        md.start_of_burst = true;
+        uhd::async_metadata_t async_md;
+        while (tx_stream->recv_async_msg(async_md, timeout_s)) {
+            if (async_md.event_code & (uhd::async_metadata_t::EVENT_CODE_UNDERFLOW |
+                                       uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)) tx_underflow = true;
+            if (async_md.event_code != uhd::async_metadata_t::EVENT_CODE_BURST_ACK) continue;
+            if (async_md.has_time_spec) return async_md.time_spec.get_real_secs() - queued_at;
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - host_queued_at).count();
+        }
+        return -1.0;
+    }
+
+    size_t recv(std::complex<float> *samples, size_t n, double timeout_s, bool &has_time, double &time_s) override {
+        uhd::rx_metadata_t rx_md;
+        size_t got = rx_stream->recv(samples, n, rx_md, timeout_s);
+        has_time = rx_md.has_time_spec;
+        if (has_time) time_s = rx_md.time_spec.get_real_secs();
+        if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) rx_overflow = true;
+        return got;
+    }
+
+    bool takeTxUnderflow() override {
+        bool underflow = tx_underflow;
+        tx_underflow = false;
+        uhd::async_metadata_t async_md;
+        while (tx_stream->recv_async_msg(async_md, 0.0)) {
+            if (async_md.event_code & (uhd::async_metadata_t::EVENT_CODE_UNDERFLOW |
+                                       uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)) underflow = true;
+        }
+        return underflow;
+    }
+
+    bool takeRxOverflow() override {
+        bool overflow = rx_overflow;
+        rx_overflow = false;
+        return overflow;
+    }
+
+private:
+    void startStreams(const RadioConfig &config) {
+        uhd::stream_args_t stream_args("fc32");
+        uhd::stream_args_t tx_args("fc32");
+        if (config.tx_spp) tx_args.args["spp"] = std::to_string(config.tx_spp);
+        if (config.tx_frames) tx_args.args["num_send_frames"] = std::to_string(config.tx_frames);
+        if (config.tx_buff_bytes) tx_args.args["send_buff_size"] = std::to_string(config.tx_buff_bytes);
+        tx_stream = usrp->get_tx_stream(tx_args);
+        if (config.rx) {
+            rx_stream = usrp->get_rx_stream(stream_args);
+            uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+            stream_cmd.stream_now = true;
+            rx_stream->issue_stream_cmd(stream_cmd);
+        }
+
+        md.start_of_burst = true;
+        md.end_of_burst = false;
+        rx_overflow = false;
+        tx_underflow = false;
+    }
+
+    uhd::usrp::multi_usrp::sptr usrp;
+    uhd::tx_streamer::sptr tx_stream;
+    uhd::rx_streamer::sptr rx_stream;
+    uhd::tx_metadata_t md;
+    bool rx_overflow = false;
+    bool tx_underflow = false; // Seen while waiting for a burst ACK
+};
+
+extern "C" __attribute__((visibility("default"))) RadioBackend *createRadioBackend() {
+    return new UhdBackend();
+}
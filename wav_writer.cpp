@@ -0,0 +1,77 @@
+#include "wav_writer.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+bool WavWriter::open(const std::string &target, uint32_t sample_rate) {
+    close();
+    total_bytes = 0;
+    part = 0;
+    path = target;
+    return openPart(target, sample_rate);
+}
+
+void WavWriter::write(const std::vector<float> &samples) {
+    if (!fp) return;
+    pcm.resize(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+        pcm[i] = int16_t(s * 32767.0f);
+    }
+    uint64_t bytes = pcm.size() * sizeof(int16_t);
+    if (seekable && data_bytes + bytes > max_data_bytes) {
+        uint32_t r = rate;
+        close();
+        if (!openPart(partName(path, ++part), r)) return;
+    }
+    fwrite(pcm.data(), sizeof(int16_t), pcm.size(), fp);
+    data_bytes += bytes;
+    total_bytes += bytes;
+}
+
+void WavWriter::close() {
+    if (!fp) return;
+    if (seekable) {
+        fseek(fp, 0, SEEK_SET);
+        writeHeader(rate, uint32_t(data_bytes));
+    }
+    if (piped) pclose(fp);
+    else if (fp != stdout) fclose(fp);
+    else fflush(fp);
+    fp = nullptr;
+    piped = seekable = false;
+}
+
+bool WavWriter::openPart(const std::string &target, uint32_t sample_rate) {
+    if (target == "-") {
+        fp = stdout;
+    } else if (!target.empty() && target[0] == '|') {
+        fp = popen(target.c_str() + 1, "w");
+        piped = true;
+    } else {
+        fp = fopen(target.c_str(), "wb");
+        seekable = true;
+    }
+    if (!fp) return false;
+    data_bytes = 0;
+    writeHeader(sample_rate, seekable ? 0 : 0xFFFFFFFFu - 36);
+    rate = sample_rate;
+    return true;
+}
+
+void WavWriter::writeHeader(uint32_t sample_rate, uint32_t bytes) {
+    fwrite("RIFF", 1, 4, fp);
+    put32(36 + bytes);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    put32(16);
+    put16(1); // PCM
+    put16(1); // Mono
+    put32(sample_rate);
+    put32(sample_rate * 2);
+    put16(2);
+    put16(16);
+    fwrite("data", 1, 4, fp);
+    put32(bytes);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 16-bit mono PCM WAV sink. The target can be a file, "-" for stdout or
+// "|command" to pipe into another program. Sizes are patched on close when
+// the target is seekable; streams get a maximal header instead. A RIFF file
+// holds at most 4 GB (about 12 hours at 48 kHz), so a file that would grow
+// past that is closed and recording carries on in "name.1.wav", "name.2.wav"...
+class WavWriter {
+public:
+    ~WavWriter() { close(); }
+
+    bool open(const std::string &target, uint32_t sample_rate);
+
+    bool isOpen() const { return fp != nullptr; }
+    double secondsWritten() const { return rate ? total_bytes / 2.0 / rate : 0.0; }
+
+    void write(const std::vector<float> &samples);
+
+    void close();
+
+private:
+    static constexpr uint64_t max_data_bytes = 0xFFFFFFFFu - 36 - 1; // Even, so no sample is split
+
+    FILE *fp = nullptr;
+    bool piped = false, seekable = false;
+    uint32_t rate = 0;
+    uint64_t data_bytes = 0;  // In the current file
+    uint64_t total_bytes = 0; // Since open()
+    std::string path;
+    unsigned part = 0;
+    std::vector<int16_t> pcm;
+
+    static std::string partName(const std::string &target, unsigned n) {
+        size_t dot = target.rfind('.');
+        if (dot == std::string::npos || target.find('/', dot) != std::string::npos) dot = target.size();
+        return target.substr(0, dot) + "." + std::to_string(n) + target.substr(dot);
+    }
+
+    bool openPart(const std::string &target, uint32_t sample_rate);
+
+    void put32(uint32_t v) { uint8_t b[4] = {uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16), uint8_t(v >> 24)}; fwrite(b, 1, 4, fp); }
+    void put16(uint16_t v) { uint8_t b[2] = {uint8_t(v), uint8_t(v >> 8)}; fwrite(b, 1, 2, fp); }
+
+    void writeHeader(uint32_t sample_rate, uint32_t bytes);
+};
@@ -0,0 +1,36 @@
+#include "waveform_library.h"
+
+size_t WaveformKeyHash::operator()(const WaveformKey &k) const {
+    size_t h = std::hash<int>()(k.type);
+    h = h * 31 + std::hash<float>()(k.amplitude);
+    h = h * 31 + std::hash<double>()(k.tone_hz);
+    h = h * 31 + std::hash<double>()(k.sample_rate);
+    return h * 31 + std::hash<uint64_t>()(k.preamble_id);
+}
+
+WaveformRef WaveformLibrary::get(const WaveformKey &key, const RenderFn &render) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+    misses++;
+    auto wf = std::make_shared<Waveform>();
+    render(key, *wf);
+    lru.emplace_front(key, wf);
+    index[key] = lru.begin();
+    bytes += sizeOf(*wf);
+    evictToBudget();
+    return wf;
+}
+
+void WaveformLibrary::evictTo(size_t limit) {
+    while (bytes > limit && lru.size() > 1) {
+        bytes -= sizeOf(*lru.back().second);
+        index.erase(lru.back().first);
+        lru.pop_back();
+        evictions++;
+    }
+}
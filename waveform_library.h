@@ -0,0 +1,87 @@
+#pragma once
+
+#include "sample_buffers.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Everything that determines a generated waveform's samples
+struct WaveformKey {
+    int type;
+    float amplitude;
+    double tone_hz;
+    double sample_rate;
+    uint64_t preamble_id; // Bumped whenever the preamble reference changes
+
+    bool operator==(const WaveformKey &o) const {
+        return type == o.type && amplitude == o.amplitude && tone_hz == o.tone_hz &&
+               sample_rate == o.sample_rate && preamble_id == o.preamble_id;
+    }
+};
+
+struct WaveformKeyHash {
+    size_t operator()(const WaveformKey &k) const;
+};
+
+// One period of a waveform; playback loops over it
+using Waveform = ArenaSampleVector;
+using WaveformRef = std::shared_ptr<const Waveform>;
+
+// Rendered waveforms kept under a RAM budget with least-recently-used
+// eviction. Entries are shared_ptrs, so evicting one that is still playing
+// only drops the library's reference.
+class WaveformLibrary {
+public:
+    using RenderFn = std::function<void(const WaveformKey &, Waveform &)>;
+
+    explicit WaveformLibrary(size_t budget_bytes) : budget(budget_bytes) {}
+
+    WaveformRef get(const WaveformKey &key, const RenderFn &render);
+
+    void setBudget(size_t budget_bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = budget_bytes;
+        evictToBudget();
+    }
+
+    // Evicts down to target_bytes without changing the budget; returns bytes freed
+    size_t trim(size_t target_bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t before = bytes;
+        evictTo(target_bytes);
+        return before - bytes;
+    }
+
+    struct Stats {
+        uint64_t hits, misses, evictions;
+        size_t entries, bytes, budget;
+    };
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {hits, misses, evictions, lru.size(), bytes, budget};
+    }
+
+private:
+    using Entry = std::pair<WaveformKey, WaveformRef>;
+    mutable std::mutex mutex;
+    std::list<Entry> lru; // Front is most recently used
+    std::unordered_map<WaveformKey, std::list<Entry>::iterator, WaveformKeyHash> index;
+    size_t budget;
+    size_t bytes = 0;
+    uint64_t hits = 0, misses = 0, evictions = 0;
+
+    static size_t sizeOf(const Waveform &wf) { return wf.size() * sizeof(std::complex<float>); }
+
+    void evictToBudget() { evictTo(budget); }
+
+    // The newest entry always survives, even if it alone exceeds the limit
+    void evictTo(size_t limit);
+};
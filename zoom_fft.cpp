@@ -0,0 +1,95 @@
+#include "zoom_fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ZoomFft::configure(double rate, double center_hz, double span_hz, size_t fft_size, size_t averages) {
+    size_t total = size_t(rate / std::max(span_hz, 1.0));
+    cic_decim = std::clamp<size_t>(total / fir_decim, 1, max_cic_decim);
+    out_rate = rate / (cic_decim * fir_decim);
+    center = center_hz;
+    alpha = 1.0f / std::max<size_t>(1, averages);
+
+    double w = -2.0 * M_PI * center_hz / rate;
+    rot = 1.0f;
+    rot_step = std::complex<float>(cos(w), sin(w));
+    for (auto &s : integ) s[0] = s[1] = 0;
+    for (auto &s : comb) s[0] = s[1] = 0;
+    cic_phase = 0;
+    cic_gain = 1.0 / (pow(double(cic_decim), cic_order) * scale);
+    // -6 dB at 0.45 of the output rate: flat across the usable span and
+    // over 80 dB down where it would alias into it
+    fir.configure(fir_decim, 48 * fir_decim + 1, 0.45 / fir_decim);
+
+    fft.resize(fft_size);
+    window.resize(fft_size);
+    double sum = 0;
+    for (size_t i = 0; i < fft_size; i++) {
+        window[i] = 0.5f - 0.5f * cos(2.0 * M_PI * i / fft_size);
+        sum += window[i];
+    }
+    norm = 1.0f / (sum * sum);
+    ring.assign(fft_size, 0.0f);
+    ring_pos = 0;
+    until_fft = fft_size;
+    avg.assign(fft_size, 0.0f);
+    spectra = 0;
+}
+
+bool ZoomFft::process(const std::complex<float> *in, size_t n, std::vector<float> &psd_db) {
+    cic_out.clear();
+    for (size_t i = 0; i < n; i++) {
+        std::complex<float> x = in[i] * rot;
+        rot *= rot_step;
+        // Integrators wrap modulo 2^64; the combs undo it exactly
+        uint64_t v[2] = {uint64_t(int64_t(x.real() * scale)), uint64_t(int64_t(x.imag() * scale))};
+        for (int c = 0; c < 2; c++) {
+            integ[0][c] += v[c];
+            for (int k = 1; k < cic_order; k++) integ[k][c] += integ[k - 1][c];
+        }
+        if (++cic_phase < cic_decim) continue;
+        cic_phase = 0;
+        double y[2];
+        for (int c = 0; c < 2; c++) {
+            uint64_t s = integ[cic_order - 1][c];
+            for (int k = 0; k < cic_order; k++) {
+                uint64_t d = s - comb[k][c];
+                comb[k][c] = s;
+                s = d;
+            }
+            y[c] = double(int64_t(s)) * cic_gain;
+        }
+        cic_out.push_back(std::complex<float>(y[0], y[1]));
+    }
+    rot /= std::abs(rot);
+    slow.clear();
+    fir.process(cic_out.data(), cic_out.size(), slow);
+
+    // The last fft_size outputs stay in a ring; a spectrum every half
+    // of it, oldest sample first
+    bool ready = false;
+    size_t len = fft.size(), hop = len / 2;
+    for (const auto &y : slow) {
+        ring[ring_pos] = y;
+        ring_pos = ring_pos + 1 == len ? 0 : ring_pos + 1;
+        if (--until_fft > 0) continue;
+        until_fft = hop;
+        scratch.resize(len);
+        size_t head = len - ring_pos;
+        for (size_t i = 0; i < head; i++) scratch[i] = ring[ring_pos + i] * window[i];
+        for (size_t i = head; i < len; i++) scratch[i] = ring[i - head] * window[i];
+        fft.forward(scratch.data());
+        float a = spectra == 0 ? 1.0f : alpha;
+        for (size_t i = 0; i < len; i++) {
+            float p = std::norm(scratch[(i + len / 2) % len]) * norm;
+            avg[i] += a * (p - avg[i]);
+        }
+        spectra++;
+        ready = true;
+    }
+    if (ready) {
+        psd_db.resize(len);
+        for (size_t i = 0; i < len; i++) psd_db[i] = 10.0f * log10f(avg[i] + 1e-20f);
+    }
+    return ready;
+}
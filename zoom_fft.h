@@ -0,0 +1,51 @@
+#pragma once
+
+#include "decimators.h"
+#include "fft.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Zoom FFT: an NCO moves the span center to DC, a 4th-order CIC and a
+// 4:1 FIR decimate, and a moderate FFT of the slow stream gives a
+// resolution of rate / (decimation * fft_size). Cost per input sample is
+// the NCO and the CIC integrators; everything after runs at the low rate.
+// Spectra use Hann windows at 50% overlap with exponential power averaging.
+class ZoomFft {
+public:
+    static constexpr size_t fir_decim = 4;
+    static constexpr size_t max_cic_decim = 1024; // Keeps CIC growth inside 64 bits
+
+    void configure(double rate, double center_hz, double span_hz, size_t fft_size, size_t averages);
+
+    double outputRate() const { return out_rate; }
+    double resolution() const { return out_rate / fft.size(); }
+    double centerHz() const { return center; }
+    // Bins worth showing; the FIR rolls off toward the edges
+    double usableSpan() const { return 0.8 * out_rate; }
+
+    // Returns true when a new spectrum (dBFS, -out_rate/2..+out_rate/2
+    // around the center) has been written to psd_db
+    bool process(const std::complex<float> *in, size_t n, std::vector<float> &psd_db);
+
+private:
+    static constexpr int cic_order = 4;
+    static constexpr double scale = 1 << 20; // Float -> CIC fixed point
+
+    size_t cic_decim = 1, cic_phase = 0;
+    double out_rate = 1, center = 0, cic_gain = 1;
+    float alpha = 1;
+    std::complex<float> rot = 1.0f, rot_step = 1.0f;
+    uint64_t integ[cic_order][2] = {}, comb[cic_order][2] = {};
+    FirDecimator<std::complex<float>> fir;
+    FFT fft;
+    std::vector<float> window, avg;
+    float norm = 1;
+    std::vector<std::complex<float>> cic_out, slow, scratch;
+    std::vector<std::complex<float>> ring; // Last fft_size FIR outputs
+    size_t ring_pos = 0;                   // Oldest sample, next to be overwritten
+    size_t until_fft = 0;                  // Outputs left before the next spectrum
+    uint64_t spectra = 0;
+};